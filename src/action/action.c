@@ -33,7 +33,7 @@
 #include "file-utils.h"
 #include "perm-cynagora/perm-cynagora.h"
 #include "mac-interface.h"
-
+#include "lock-manager.h"
 
 /***********************/
 /*** PRIVATE METHODS ***/
@@ -62,7 +62,7 @@ static int check_plug_installable(context_t *context)
     int rc = 0;
 
     /* iterate over the plug requests */
-    for(plugit = context->plugset ; plugit != NULL ; plugit = plugit->next) {
+    for(plugit = context->plugset.first ; plugit != NULL ; plugit = plugit->next) {
 
         /* compute the label of the application importing the plug */
         mac_get_label(label, plugit->impid);
@@ -113,13 +113,57 @@ static int check_context(context_t *context, char label[SEC_LSM_MANAGER_MAX_SIZE
     return 0;
 }
 
-/**********************/
-/*** PUBLIC METHODS ***/
-/**********************/
+/**
+ * @brief Lock the resources modified by actions on the application:
+ * its identifier and the directories where its plugs are imported
+ *
+ * @param[in] context the application
+ * @param[out] set the set of locked resources
+ * @return 0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int lock_context(const context_t *context, lock_set_t *set)
+{
+    plug_t *plugit;
+    unsigned count = 1;
 
-/* see action.h */
+    for (plugit = context->plugset.first ; plugit != NULL ; plugit = plugit->next)
+        count++;
+    set->keys = malloc(count * sizeof *set->keys);
+    if (set->keys == NULL)
+        return -ENOMEM;
+
+    set->keys[0].kind = lock_app_id;
+    set->keys[0].name = context->id;
+    for (count = 1, plugit = context->plugset.first ; plugit != NULL ; plugit = plugit->next, count++) {
+        set->keys[count].kind = lock_plug_dir;
+        set->keys[count].name = plugit->impdir;
+    }
+    set->count = count;
+    lock_manager_acquire(set);
+    return 0;
+}
+
+/**
+ * @brief Unlock the resources locked by lock_context
+ *
+ * @param[in] set the set of locked resources
+ */
+__nonnull()
+static void unlock_context(lock_set_t *set)
+{
+    lock_manager_release(set);
+    free(set->keys);
+}
+
+/**
+ * @brief Install the application, see action_install
+ *
+ * @param[in] context the application to be installed
+ * @return 0 in case of success or a negative -errno value
+ */
 __nonnull() __wur
-int action_install(context_t *context)
+static int install(context_t *context)
 {
     /* check consistency */
     char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1];
@@ -160,9 +204,14 @@ int action_install(context_t *context)
     return 0;
 }
 
-/* see action.h */
+/**
+ * @brief Uninstall the application, see action_uninstall
+ *
+ * @param[in] context the application to be uninstalled
+ * @return 0 in case of success or a negative -errno value
+ */
 __nonnull() __wur
-int action_uninstall(context_t *context)
+static int uninstall(context_t *context)
 {
     /* check consistency */
     char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1];
@@ -192,3 +241,34 @@ int action_uninstall(context_t *context)
     return 0;
 }
 
+/**********************/
+/*** PUBLIC METHODS ***/
+/**********************/
+
+/* see action.h */
+__nonnull() __wur
+int action_install(context_t *context)
+{
+    lock_set_t set;
+    int rc = lock_context(context, &set);
+
+    if (rc >= 0) {
+        rc = install(context);
+        unlock_context(&set);
+    }
+    return rc;
+}
+
+/* see action.h */
+__nonnull() __wur
+int action_uninstall(context_t *context)
+{
+    lock_set_t set;
+    int rc = lock_context(context, &set);
+
+    if (rc >= 0) {
+        rc = uninstall(context);
+        unlock_context(&set);
+    }
+    return rc;
+}
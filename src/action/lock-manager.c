@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "lock-manager.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** mutex protecting the list of locked sets */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** condition signaling the unlocking of sets */
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+/** list of the locked sets */
+static lock_set_t *locked_sets = NULL;
+
+/**
+ * @brief Check if two keys are the same
+ *
+ * @param[in] a first key
+ * @param[in] b second key
+ * @return true if same, false otherwise
+ */
+__nonnull() __wur
+static bool same_key(const lock_key_t *a, const lock_key_t *b)
+{
+    return a->kind == b->kind && strcmp(a->name, b->name) == 0;
+}
+
+/**
+ * @brief Check if some resource of the set is already locked
+ *
+ * @param[in] set the set to check
+ * @return true if some resource is locked, false otherwise
+ */
+__nonnull() __wur
+static bool is_locked(const lock_set_t *set)
+{
+    const lock_set_t *iter;
+    unsigned i, j;
+
+    for (iter = locked_sets ; iter != NULL ; iter = iter->next)
+        for (i = 0 ; i < set->count ; i++)
+            for (j = 0 ; j < iter->count ; j++)
+                if (same_key(&set->keys[i], &iter->keys[j]))
+                    return true;
+    return false;
+}
+
+/**********************/
+/*** PUBLIC METHODS ***/
+/**********************/
+
+/* see lock-manager.h */
+__nonnull()
+void lock_manager_acquire(lock_set_t *set)
+{
+    pthread_mutex_lock(&mutex);
+    while (is_locked(set))
+        pthread_cond_wait(&cond, &mutex);
+    set->next = locked_sets;
+    locked_sets = set;
+    pthread_mutex_unlock(&mutex);
+}
+
+/* see lock-manager.h */
+__nonnull()
+void lock_manager_release(lock_set_t *set)
+{
+    lock_set_t **prev;
+
+    pthread_mutex_lock(&mutex);
+    for (prev = &locked_sets ; *prev != NULL ; prev = &(*prev)->next)
+        if (*prev == set) {
+            *prev = set->next;
+            break;
+        }
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_LOCK_MANAGER_H
+#define SEC_LSM_MANAGER_LOCK_MANAGER_H
+
+#include <features.h>
+
+/** kinds of locked resources */
+typedef enum lock_kind {
+    /** an application identifier */
+    lock_app_id,
+    /** a directory of imported plugs */
+    lock_plug_dir
+} lock_kind_t;
+
+/** key of a locked resource */
+typedef struct lock_key {
+    /** the kind of the resource */
+    lock_kind_t kind;
+    /** the name of the resource */
+    const char *name;
+} lock_key_t;
+
+/** set of locked resources */
+typedef struct lock_set lock_set_t;
+
+/**
+ * Structure of sets of locked resources, allocated by the caller
+ * and kept alive while locked
+ */
+struct lock_set {
+    /** the keys of the resources */
+    lock_key_t *keys;
+
+    /** count of keys */
+    unsigned count;
+
+    /** link to the next locked set, private to the lock manager */
+    lock_set_t *next;
+};
+
+/**
+ * @brief Lock all the resources of the set at once, waiting until none
+ * of them is locked by an other set. Because the resources are all locked
+ * together, no dead lock can occur between sets.
+ *
+ * @param[in] set the set of resources to lock
+ */
+__nonnull()
+extern void lock_manager_acquire(lock_set_t *set);
+
+/**
+ * @brief Unlock the resources of the set
+ *
+ * @param[in] set the set of resources locked by lock_manager_acquire
+ */
+__nonnull()
+extern void lock_manager_release(lock_set_t *set);
+
+#endif
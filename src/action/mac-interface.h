@@ -28,5 +28,6 @@
  __wur __nonnull() extern int mac_install(const context_t *context);
  __wur __nonnull() extern int mac_uninstall(const context_t *context);
 __nonnull() extern void mac_get_label(char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1], const char *appid);
+ __wur extern int mac_reference_permissions(void);
 
 #endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "arena.h"
+
+#include <stdalign.h>
+#include <stdlib.h>
+
+/** size of the usual blocks */
+#define ARENA_BLOCK_SIZE 16384
+
+/** alignment of the allocations */
+#define ARENA_ALIGN alignof(max_align_t)
+
+/**
+ * block of memory of the arena
+ */
+struct arena_block {
+    /** next block, allocated before */
+    struct arena_block *next;
+    /** size of data */
+    size_t size;
+    /** size of data used */
+    size_t used;
+    /** the data */
+    alignas(max_align_t) char data[];
+};
+
+/* see arena.h */
+__nonnull()
+void arena_init(arena_t *arena, size_t limit)
+{
+    arena->blocks = NULL;
+    arena->total = 0;
+    arena->limit = limit;
+}
+
+/* see arena.h */
+__wur __nonnull()
+void *arena_alloc(arena_t *arena, size_t size)
+{
+    struct arena_block *block = arena->blocks;
+    size_t bsize;
+
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (block != NULL && block->size - block->used >= size) {
+        block->used += size;
+        return &block->data[block->used - size];
+    }
+
+    /* allocates a new block, big allocations get their own block */
+    bsize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+    if (bsize > arena->limit - arena->total)
+        return NULL;
+    block = malloc(sizeof *block + bsize);
+    if (block == NULL)
+        return NULL;
+    block->size = bsize;
+    block->used = size;
+    arena->total += bsize;
+
+    /* the current block stays first when the new block is full */
+    if (bsize == size && arena->blocks != NULL) {
+        block->next = arena->blocks->next;
+        arena->blocks->next = block;
+    }
+    else {
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+    return block->data;
+}
+
+/* see arena.h */
+__nonnull()
+void arena_reset(arena_t *arena)
+{
+    struct arena_block *block, *kept = NULL;
+
+    while ((block = arena->blocks) != NULL) {
+        arena->blocks = block->next;
+        if (kept == NULL && block->size == ARENA_BLOCK_SIZE)
+            kept = block;
+        else
+            free(block);
+    }
+    if (kept != NULL) {
+        kept->next = NULL;
+        kept->used = 0;
+        arena->blocks = kept;
+        arena->total = kept->size;
+    }
+    else
+        arena->total = 0;
+}
+
+/* see arena.h */
+__nonnull()
+void arena_release(arena_t *arena)
+{
+    struct arena_block *block;
+
+    while ((block = arena->blocks) != NULL) {
+        arena->blocks = block->next;
+        free(block);
+    }
+    arena->total = 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_ARENA_H
+#define SEC_LSM_MANAGER_ARENA_H
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+/**
+ * @brief Structure of arena
+ *
+ * An arena allocates memory from blocks that are only released
+ * all at once by arena_reset or arena_release.
+ */
+typedef struct arena {
+    struct arena_block *blocks; /**< blocks, the current one first */
+    size_t total;               /**< total size of the blocks */
+    size_t limit;               /**< maximum total size of the blocks */
+} arena_t;
+
+/**
+ * @brief Initialize an empty arena
+ *
+ * @param[in] arena arena handler
+ * @param[in] limit maximum size of the memory of the arena
+ */
+__nonnull()
+extern void arena_init(arena_t *arena, size_t limit);
+
+/**
+ * @brief Allocate memory in the arena. The memory is aligned
+ * for any type.
+ *
+ * @param[in] arena arena handler
+ * @param[in] size size of the memory to allocate
+ * @return the allocated memory or NULL when out of memory or
+ *         when the limit of the arena would be exceeded
+ */
+__wur __nonnull()
+extern void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * @brief Release the memory allocated in the arena but keep
+ * its first block for next allocations
+ *
+ * @param[in] arena arena handler
+ */
+__nonnull()
+extern void arena_reset(arena_t *arena);
+
+/**
+ * @brief Release all the memory of the arena
+ *
+ * @param[in] arena arena handler
+ */
+__nonnull()
+extern void arena_release(arena_t *arena);
+
+#endif
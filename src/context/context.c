@@ -33,6 +33,17 @@
 #include "file-utils.h"
 #include "path-utils.h"
 
+#if !defined(CONTEXT_ARENA_MAX_SIZE)
+#define CONTEXT_ARENA_MAX_SIZE 16777216
+#endif
+
+/**
+ * permissions referenced by templates, the position of a permission in the
+ * set is the index of its bit in referenced_bits of contexts
+ * (a zeroed set is initialized)
+ */
+static permission_set_t referenced_permissions;
+
 /***********************/
 /*** PRIVATE METHODS ***/
 /***********************/
@@ -45,12 +56,14 @@
 __nonnull()
 void context_init(context_t *context) {
     memset(context->id, '\0', SEC_LSM_MANAGER_MAX_SIZE_ID);
-    path_set_init(&(context->path_set));
-    plugset_init(&(context->plugset));
+    arena_init(&(context->arena), CONTEXT_ARENA_MAX_SIZE);
+    path_set_init(&(context->path_set), &(context->arena));
+    plugset_init(&(context->plugset), &(context->arena));
     permission_set_init(&(context->permission_set));
     context->need_id = false;
     context->error_flag = false;
     context->permgr = NULL;
+    memset(context->referenced_bits, 0, sizeof context->referenced_bits);
 }
 
 /**
@@ -71,7 +84,7 @@ static int setids(
 ) {
     int rc = context_is_valid_id(src);
     if (rc >= 0) {
-        memcpy(id, src, (unsigned)rc);
+        memcpy(id, src, (unsigned)rc + 1);
         rc = 0;
     }
     return rc;
@@ -82,6 +95,29 @@ static int setids(
 /*** PUBLIC METHODS ***/
 /**********************/
 
+/* see context.h */
+__nonnull() __wur
+int context_reference_permission(const char *permission)
+{
+    int rc = permission_set_position(&referenced_permissions, permission);
+
+    if (rc < 0) {
+        if (referenced_permissions.size >= CONTEXT_MAX_REFERENCED_PERMISSIONS)
+            return -ENOSPC;
+        rc = permission_set_add(&referenced_permissions, permission);
+        if (rc == 0)
+            rc = (int)referenced_permissions.size - 1;
+    }
+    return rc;
+}
+
+/* see context.h */
+__nonnull() __wur
+int context_referenced_permission_bit(const char *permission)
+{
+    return permission_set_position(&referenced_permissions, permission);
+}
+
 /* see context.h */
 __nonnull() __wur
 int context_create(context_t **context) {
@@ -99,6 +135,7 @@ int context_create(context_t **context) {
 __nonnull()
 void context_destroy(context_t *context) {
     context_clear(context);
+    arena_release(&(context->arena));
     free(context);
 }
 
@@ -109,6 +146,8 @@ void context_clear(context_t *context) {
     permission_set_clear(&(context->permission_set));
     plugset_clear(&(context->plugset));
     path_set_clear(&(context->path_set));
+    arena_reset(&(context->arena));
+    memset(context->referenced_bits, 0, sizeof context->referenced_bits);
     context->need_id = false;
     context->error_flag = false;
 }
@@ -208,6 +247,9 @@ int context_add_permission(context_t *context, const char *permission)
         ERROR("permission_set_add: %d %s", -rc, strerror(-rc));
         return rc;
     }
+    rc = permission_set_position(&referenced_permissions, permission);
+    if (rc >= 0)
+        context->referenced_bits[rc / 64] |= (uint64_t)1 << (rc % 64);
     context->need_id = true;
 
     return 0;
@@ -355,9 +397,20 @@ int context_add_plug(context_t *context, const char *expdir, const char *impid,
 __nonnull() __wur
 int context_has_permission(const context_t *context, const char *permission)
 {
+    int bit = permission_set_position(&referenced_permissions, permission);
+
+    if (bit >= 0)
+        return context_has_referenced_permission(context, bit);
     return permission_set_has(&context->permission_set, permission);
 }
 
+/* see context.h */
+__nonnull() __wur
+bool context_has_referenced_permission(const context_t *context, int bit)
+{
+    return (context->referenced_bits[bit / 64] >> (bit % 64)) & 1;
+}
+
 /* see context.h */
 __nonnull((1,2)) __wur
 int context_visit(context_t *context, void *visitor, const context_visitor_itf_t *itf)
@@ -380,7 +433,7 @@ int context_visit(context_t *context, void *visitor, const context_visitor_itf_t
             rc = itf->permission(visitor, context->permission_set.permissions[i]);
 
     if (itf->plug != NULL)
-        for (plugit = context->plugset ; !rc && plugit != NULL ; plugit = plugit->next)
+        for (plugit = context->plugset.first ; !rc && plugit != NULL ; plugit = plugit->next)
             rc = itf->plug(visitor, plugit->expdir, plugit->impid, plugit->impdir);
 
     return rc;
@@ -24,14 +24,19 @@
 #ifndef SEC_LSM_MANAGER_CONTEXT_H
 #define SEC_LSM_MANAGER_CONTEXT_H
 
+#include <stdint.h>
 #include <sys/types.h>
 
 #include "sizes.h"
+#include "arena.h"
 #include "permissions.h"
 #include "paths.h"
 #include "plugs.h"
 #include "perm-mgr.h"
 
+/** maximum count of permissions referenced by the templates */
+#define CONTEXT_MAX_REFERENCED_PERMISSIONS 256
+
 typedef struct context {
     char id[SEC_LSM_MANAGER_MAX_SIZE_ID + 1];
     permission_set_t permission_set;
@@ -40,8 +45,48 @@ typedef struct context {
     bool need_id; /**< flags if id is needed */
     bool error_flag;
     const perm_mgr_itf_t *permgr;
+    arena_t arena; /**< memory of the paths and plugs */
+    /** bits of the referenced permissions of the context, see context_reference_permission */
+    uint64_t referenced_bits[CONTEXT_MAX_REFERENCED_PERMISSIONS / 64];
 } context_t;
 
+/**
+ * @brief Reference a permission checked by the templates. The referenced
+ * permissions get a bit in the contexts, so checking them is a bit test.
+ * The permissions must be referenced before creating contexts.
+ *
+ * @param[in] permission the permission
+ * @return
+ *    * the index of the bit of the permission (greater or equal to zero)
+ *    * -EINVAL        bad permission
+ *    * -ENOSPC        too many permissions are referenced
+ *    * -ENOMEM        out of memory
+ */
+__nonnull() __wur
+extern int context_reference_permission(const char *permission);
+
+/**
+ * @brief Get the bit of a permission referenced by the templates,
+ * without referencing it
+ *
+ * @param[in] permission the permission
+ * @return
+ *    * the index of the bit of the permission (greater or equal to zero)
+ *    * -ENOENT        the permission isn't referenced
+ */
+__nonnull() __wur
+extern int context_referenced_permission_bit(const char *permission);
+
+/**
+ * @brief Check if the context has the referenced permission of the bit
+ *
+ * @param[in] context handler
+ * @param[in] bit the bit returned by context_reference_permission
+ * @return true if the context has the permission
+ */
+__nonnull() __wur
+extern bool context_has_referenced_permission(const context_t *context, int bit);
+
 /**
  * @brief Initialize the fields 'id', 'id_underscore', 'permission_set', 'path_set' and error_flag
  *
@@ -73,7 +118,7 @@ extern void context_destroy(context_t *context);
 
 /**
  * @brief Free id, paths and permissions
- * The pointer is not free
+ * The pointer is not free, the first block of the arena is kept
  *
  * @param[in] context handler
  */
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "interned.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** minimal count of buckets */
+#define INTERNED_MIN_BUCKETS 64
+
+/**
+ * interned string
+ */
+struct interned {
+    /** next interned string of the bucket */
+    struct interned *next;
+    /** hash of the string */
+    uint32_t hash;
+    /** count of references */
+    unsigned refcount;
+    /** the string */
+    char value[];
+};
+
+/** buckets of the interned strings */
+static struct interned **buckets = NULL;
+
+/** count of buckets, a power of 2 */
+static size_t bucket_count = 0;
+
+/** count of interned strings */
+static size_t count = 0;
+
+/** protection of the interned strings */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Compute the hash of a string (FNV-1a)
+ *
+ * @param[in] str the string
+ * @param[out] length the length of the string
+ * @return the hash
+ */
+__nonnull()
+static uint32_t hash_string(const char *str, size_t *length)
+{
+    uint32_t hash = 2166136261u;
+    const unsigned char *iter = (const unsigned char *)str;
+
+    while (*iter)
+        hash = (hash ^ (uint32_t)*iter++) * 16777619u;
+    *length = (size_t)(iter - (const unsigned char *)str);
+    return hash;
+}
+
+/**
+ * @brief Double the count of buckets when there are more strings than
+ * buckets. On allocation failure, the buckets are kept as they are.
+ */
+static void grow_buckets(void)
+{
+    struct interned **nbuckets, *item, *next;
+    size_t ncount, idx;
+
+    if (count < bucket_count)
+        return;
+
+    ncount = bucket_count ? 2 * bucket_count : INTERNED_MIN_BUCKETS;
+    nbuckets = calloc(ncount, sizeof *nbuckets);
+    if (nbuckets == NULL)
+        return;
+
+    for (idx = 0 ; idx < bucket_count ; idx++) {
+        for (item = buckets[idx] ; item != NULL ; item = next) {
+            next = item->next;
+            item->next = nbuckets[item->hash & (ncount - 1)];
+            nbuckets[item->hash & (ncount - 1)] = item;
+        }
+    }
+    free(buckets);
+    buckets = nbuckets;
+    bucket_count = ncount;
+}
+
+/* see interned.h */
+__wur __nonnull()
+const char *interned_get(const char *str)
+{
+    struct interned *item = NULL, **head;
+    size_t length;
+    uint32_t hash = hash_string(str, &length);
+
+    pthread_mutex_lock(&mutex);
+    grow_buckets();
+    if (bucket_count != 0) {
+        /* search the string */
+        head = &buckets[hash & (bucket_count - 1)];
+        for (item = *head ; item != NULL ; item = item->next)
+            if (item->hash == hash && strcmp(item->value, str) == 0)
+                break;
+
+        if (item != NULL)
+            item->refcount++;
+        else {
+            /* add the string */
+            item = malloc(sizeof *item + length + 1);
+            if (item != NULL) {
+                item->hash = hash;
+                item->refcount = 1;
+                memcpy(item->value, str, length + 1);
+                item->next = *head;
+                *head = item;
+                count++;
+            }
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+    return item != NULL ? item->value : NULL;
+}
+
+/* see interned.h */
+__nonnull()
+void interned_put(const char *interned)
+{
+    struct interned *item, **prev;
+
+    /* the interned copies are the values of their items */
+    item = (struct interned *)(uintptr_t)(interned - offsetof(struct interned, value));
+    pthread_mutex_lock(&mutex);
+    if (--item->refcount == 0) {
+        prev = &buckets[item->hash & (bucket_count - 1)];
+        while (*prev != item)
+            prev = &(*prev)->next;
+        *prev = item->next;
+        count--;
+        free(item);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+/* see interned.h */
+size_t interned_count(void)
+{
+    size_t result;
+
+    pthread_mutex_lock(&mutex);
+    result = count;
+    pthread_mutex_unlock(&mutex);
+    return result;
+}
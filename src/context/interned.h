@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_INTERNED_H
+#define SEC_LSM_MANAGER_INTERNED_H
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+/**
+ * @brief Get the interned copy of a string
+ *
+ * The interned copies are shared by the whole process: equal strings
+ * have the same interned copy, so they can be compared as pointers.
+ * Each call must be balanced by a call to interned_put.
+ *
+ * @param[in] str the string to intern
+ * @return the interned copy of str or NULL when out of memory
+ */
+__wur __nonnull()
+extern const char *interned_get(const char *str);
+
+/**
+ * @brief Release an interned copy got with interned_get
+ *
+ * @param[in] interned the interned copy to release
+ */
+__nonnull()
+extern void interned_put(const char *interned);
+
+/**
+ * @brief Get the count of distinct interned strings
+ *
+ * @return the count of interned strings
+ */
+extern size_t interned_count(void);
+
+#endif
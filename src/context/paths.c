@@ -24,6 +24,7 @@
 #include "paths.h"
 
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -46,19 +47,125 @@ static const char *type_strings[number_path_type] =
 [type_public] = "public"
 };
 
+/** minimal count of items of paths */
+#define PATH_SET_MIN_CAPACITY 8
+
+/** minimal count of slots of the index */
+#define PATH_INDEX_MIN_SIZE 16
+
+/**
+ * slot of the index
+ */
+struct path_slot {
+    /** hash of the path */
+    uint32_t hash;
+    /** index of the path plus one or 0 for free slots */
+    uint32_t position;
+};
+
 /***********************/
 /*** PRIVATE METHODS ***/
 /***********************/
 
-static path_t *path_set_search(path_set_t *path_set, const char *path)
+/**
+ * @brief Compute the hash of the path (FNV-1a)
+ *
+ * @param[in] path the path
+ * @return the hash
+ */
+__nonnull()
+static uint32_t hash_path(const char *path)
+{
+    uint32_t hash = 2166136261u;
+    const unsigned char *iter = (const unsigned char *)path;
+
+    while (*iter)
+        hash = (hash ^ (uint32_t)*iter++) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief Search the slot of the index for the path. The index
+ * must exist.
+ *
+ * @param[in] path_set path_set handler
+ * @param[in] path the path to search
+ * @param[in] hash the hash of the path
+ * @return the slot of the path or the free slot where to add it
+ */
+__nonnull()
+static struct path_slot *search_slot(const path_set_t *path_set, const char *path, uint32_t hash)
+{
+    size_t mask = path_set->index_size - 1;
+    size_t idx = hash & mask;
+    struct path_slot *slot;
+
+    for (;; idx = (idx + 1) & mask) {
+        slot = &path_set->index[idx];
+        if (slot->position == 0
+         || (slot->hash == hash && strcmp(path, path_set->paths[slot->position - 1]->path) == 0))
+            return slot;
+    }
+}
+
+/**
+ * @brief Ensure the index has room for one more path, keeping
+ * its load under 1/2
+ *
+ * @param[in] path_set path_set handler
+ * @return 0 on success or -ENOMEM
+ */
+__nonnull() __wur
+static int ensure_index_room(path_set_t *path_set)
 {
-    size_t idx;
-    for (idx = 0 ; idx < path_set->size ; idx++) {
-        path_t *p = path_set->paths[idx];
-        if (0 == strcmp(path, p->path))
-            return p;
+    struct path_slot *index, *old = path_set->index;
+    size_t size, mask, idx, pos, oldsize = path_set->index_size;
+
+    if (2 * (path_set->size + 1) <= oldsize)
+        return 0;
+
+    size = oldsize ? 2 * oldsize : PATH_INDEX_MIN_SIZE;
+    index = calloc(size, sizeof *index);
+    if (index == NULL)
+        return -ENOMEM;
+
+    /* move the slots */
+    mask = size - 1;
+    for (idx = 0 ; idx < oldsize ; idx++) {
+        if (old[idx].position) {
+            for (pos = old[idx].hash & mask ; index[pos].position ; pos = (pos + 1) & mask);
+            index[pos] = old[idx];
+        }
     }
-    return NULL;
+    free(old);
+    path_set->index = index;
+    path_set->index_size = size;
+    return 0;
+}
+
+/**
+ * @brief Ensure the array of paths has room for one more path,
+ * its capacity is doubled when full
+ *
+ * @param[in] path_set path_set handler
+ * @return 0 on success or -ENOMEM
+ */
+__nonnull() __wur
+static int ensure_paths_room(path_set_t *path_set)
+{
+    path_t **paths;
+    size_t capacity;
+
+    if (path_set->size < path_set->capacity)
+        return 0;
+
+    capacity = path_set->capacity ? 2 * path_set->capacity : PATH_SET_MIN_CAPACITY;
+    paths = (path_t **)realloc(path_set->paths, capacity * sizeof *paths);
+    if (paths == NULL)
+        return -ENOMEM;
+    path_set->paths = paths;
+    path_set->capacity = capacity;
+    return 0;
 }
 
 /**********************/
@@ -66,21 +173,31 @@ static path_t *path_set_search(path_set_t *path_set, const char *path)
 /**********************/
 
 /* see paths.h */
-__nonnull()
-void path_set_init(path_set_t *path_set)
+__nonnull((1))
+void path_set_init(path_set_t *path_set, arena_t *arena)
 {
+    path_set->arena = arena;
     path_set->size = 0;
     path_set->paths = NULL;
+    path_set->capacity = 0;
+    path_set->index = NULL;
+    path_set->index_size = 0;
 }
 
 /* see paths.h */
 __nonnull()
 void path_set_clear(path_set_t *path_set)
 {
+    if (path_set->arena != NULL)
+        path_set->size = 0;
     while(path_set->size)
         free(path_set->paths[--path_set->size]);
     free(path_set->paths);
     path_set->paths = NULL;
+    path_set->capacity = 0;
+    free(path_set->index);
+    path_set->index = NULL;
+    path_set->index_size = 0;
 }
 
 /* see paths.h */
@@ -88,7 +205,10 @@ __wur __nonnull()
 int path_set_add(path_set_t *path_set, const char *path, enum path_type path_type)
 {
     size_t path_len = strlen(path);
-    path_t **path_set_tmp, *path_item;
+    path_t *path_item;
+    struct path_slot *slot;
+    uint32_t hash;
+    int rc;
 
     if (path_len < 1 || path_len >= SEC_LSM_MANAGER_MAX_SIZE_PATH) {
         ERROR("invalid path size : %ld", path_len);
@@ -100,14 +220,22 @@ int path_set_add(path_set_t *path_set, const char *path, enum path_type path_typ
         return -EINVAL;
     }
 
-    path_set_tmp = (path_t **)realloc(path_set->paths, sizeof(path_t*) * (path_set->size + 1));
-    if (path_set_tmp == NULL) {
+    rc = ensure_paths_room(path_set);
+    if (rc < 0) {
         ERROR("realloc path_set_t");
-        return -ENOMEM;
+        return rc;
+    }
+
+    rc = ensure_index_room(path_set);
+    if (rc < 0) {
+        ERROR("alloc path index");
+        return rc;
     }
-    path_set->paths = path_set_tmp;
 
-    path_item = (path_t *)malloc(sizeof(path_t) + path_len + 1);
+    if (path_set->arena != NULL)
+        path_item = (path_t *)arena_alloc(path_set->arena, sizeof(path_t) + path_len + 1);
+    else
+        path_item = (path_t *)malloc(sizeof(path_t) + path_len + 1);
     if (path_item == NULL) {
         ERROR("malloc path_item");
         return -ENOMEM;
@@ -118,6 +246,14 @@ int path_set_add(path_set_t *path_set, const char *path, enum path_type path_typ
     path_item->path_type = path_type;
     path_set->paths[path_set->size++] = path_item;
 
+    /* index it unless a same path is already indexed */
+    hash = hash_path(path_item->path);
+    slot = search_slot(path_set, path_item->path, hash);
+    if (slot->position == 0) {
+        slot->hash = hash;
+        slot->position = (uint32_t)path_set->size;
+    }
+
     return 0;
 }
 
@@ -153,6 +289,7 @@ const char *path_type_name(enum path_type path_type)
 __wur __nonnull()
 bool path_set_has(path_set_t *path_set, const char *path)
 {
-    return NULL != path_set_search(path_set, path);
+    return path_set->index != NULL
+        && search_slot(path_set, path, hash_path(path))->position != 0;
 }
 
@@ -28,6 +28,8 @@
 #include <stddef.h>
 #include <sys/cdefs.h>
 
+#include "arena.h"
+
 /**
  * @brief several type path
  *
@@ -76,15 +78,24 @@ typedef struct path {
 typedef struct path_set {
     path_t **paths;
     size_t size;
+    /** count of allocated items of paths */
+    size_t capacity;
+    /** open addressing index of paths, NULL when empty */
+    struct path_slot *index;
+    /** count of slots of the index, a power of 2 */
+    size_t index_size;
+    /** arena of the path items or NULL for the heap */
+    arena_t *arena;
 } path_set_t;
 
 /**
- * @brief Initialize the fields 'size' and 'paths'
+ * @brief Initialize the fields of the path_set
  *
  * @param[in] path_set path_set handler
+ * @param[in] arena arena where to allocate the paths or NULL for the heap
  */
-__nonnull()
-extern void path_set_init(path_set_t *path_set);
+__nonnull((1))
+extern void path_set_init(path_set_t *path_set, arena_t *arena);
 
 /**
  * @brief Free paths that have been added
@@ -17,20 +17,123 @@
 
 #include "permissions.h"
 
+#include <ctype.h>
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "interned.h"
 #include "log.h"
 #include "file-utils.h"
 #include "sizes.h"
 
 #if PERMISSIONS_DISTINCT_CASE
 # define compare_permission strcmp
+# define fold_permission_char(c) (c)
 #else
 # define compare_permission strcasecmp
+# define fold_permission_char(c) tolower(c)
 #endif
 
+/** minimal count of slots of the index */
+#define PERMISSION_INDEX_MIN_SIZE 16
+
+/**
+ * slot of the index, the permissions equal for compare_permission
+ * have the same hash
+ */
+struct permission_slot {
+    /** hash of the permission */
+    uint32_t hash;
+    /** index of the permission plus one or 0 for free slots */
+    uint32_t position;
+};
+
+/***********************/
+/*** PRIVATE METHODS ***/
+/***********************/
+
+/**
+ * @brief Compute the hash of the permission, folding its case
+ * as compare_permission does (FNV-1a)
+ *
+ * @param[in] permission the permission
+ * @return the hash
+ */
+__nonnull()
+static uint32_t hash_permission(const char *permission)
+{
+    uint32_t hash = 2166136261u;
+    const unsigned char *iter = (const unsigned char *)permission;
+
+    while (*iter)
+        hash = (hash ^ (uint32_t)fold_permission_char(*iter++)) * 16777619u;
+    return hash;
+}
+
+/**
+ * @brief Search the slot of the index for the permission. The index
+ * must exist.
+ *
+ * @param[in] permission_set The permission_set handler
+ * @param[in] permission the permission to search
+ * @param[in] hash the hash of the permission
+ * @return the slot of the permission or the free slot where to add it
+ */
+__nonnull()
+static struct permission_slot *search_slot(const permission_set_t *permission_set,
+                                           const char *permission, uint32_t hash)
+{
+    size_t mask = permission_set->index_size - 1;
+    size_t idx = hash & mask;
+    struct permission_slot *slot;
+
+    for (;; idx = (idx + 1) & mask) {
+        slot = &permission_set->index[idx];
+        if (slot->position == 0
+         || (slot->hash == hash
+          && (permission == permission_set->permissions[slot->position - 1]
+           || compare_permission(permission, permission_set->permissions[slot->position - 1]) == 0)))
+            return slot;
+    }
+}
+
+/**
+ * @brief Ensure the index has room for one more permission, keeping
+ * its load under 1/2
+ *
+ * @param[in] permission_set The permission_set handler
+ * @return 0 on success or -ENOMEM
+ */
+__nonnull() __wur
+static int ensure_index_room(permission_set_t *permission_set)
+{
+    struct permission_slot *index, *old = permission_set->index;
+    size_t size, mask, idx, pos, oldsize = permission_set->index_size;
+
+    if (2 * (permission_set->size + 1) <= oldsize)
+        return 0;
+
+    size = oldsize ? 2 * oldsize : PERMISSION_INDEX_MIN_SIZE;
+    index = calloc(size, sizeof *index);
+    if (index == NULL)
+        return -ENOMEM;
+
+    /* move the slots, their permissions are distinct */
+    mask = size - 1;
+    for (idx = 0 ; idx < oldsize ; idx++) {
+        if (old[idx].position) {
+            for (pos = old[idx].hash & mask ; index[pos].position ; pos = (pos + 1) & mask);
+            index[pos] = old[idx];
+        }
+    }
+    free(old);
+    permission_set->index = index;
+    permission_set->index_size = size;
+    return 0;
+}
+
 /**********************/
 /*** PUBLIC METHODS ***/
 /**********************/
@@ -40,30 +143,39 @@ __nonnull()
 void permission_set_init(permission_set_t *permission_set) {
     permission_set->size = 0;
     permission_set->permissions = NULL;
+    permission_set->index = NULL;
+    permission_set->index_size = 0;
 }
 
 /* see permissions.h */
 __nonnull()
 void permission_set_clear(permission_set_t *permission_set) {
     while (permission_set->size)
-        free(permission_set->permissions[--permission_set->size]);
+        interned_put(permission_set->permissions[--permission_set->size]);
     free(permission_set->permissions);
     permission_set->permissions = NULL;
+    free(permission_set->index);
+    permission_set->index = NULL;
+    permission_set->index_size = 0;
 }
 
 /* see permissions.h */
 __nonnull() __wur
 bool permission_set_has(const permission_set_t *permission_set, const char *permission)
 {
-    char **parray = permission_set->permissions;
-    size_t nrp = permission_set->size;
-    size_t idxp = 0;
-    while (idxp < nrp)
-        if (compare_permission(permission, parray[idxp]) == 0)
-            return true;
-        else
-            idxp++;
-    return false;
+    return permission_set->index != NULL
+        && search_slot(permission_set, permission, hash_permission(permission))->position != 0;
+}
+
+/* see permissions.h */
+__nonnull() __wur
+int permission_set_position(const permission_set_t *permission_set, const char *permission)
+{
+    uint32_t position = 0;
+
+    if (permission_set->index != NULL)
+        position = search_slot(permission_set, permission, hash_permission(permission))->position;
+    return position != 0 ? (int)(position - 1) : -ENOENT;
 }
 
 /* see permissions.h */
@@ -71,7 +183,11 @@ __nonnull() __wur
 int permission_set_add(permission_set_t *permission_set, const char *permission) {
 
     size_t size;
-    void *ptr, *perm;
+    void *ptr;
+    const char *perm;
+    struct permission_slot *slot;
+    uint32_t hash;
+    int rc;
 
     /* avoid duplication of permisssion */
     if (permission_set_has(permission_set, permission))
@@ -85,29 +201,40 @@ int permission_set_add(permission_set_t *permission_set, const char *permission)
         return -EINVAL;
     }
 
-    /* copy the permission */
-    perm = malloc(1 + size);
-    if (perm == NULL) {
-        ERROR("malloc perm");
-        return -ENOMEM;
+    /* ensure room in the index */
+    rc = ensure_index_room(permission_set);
+    if (rc < 0) {
+        ERROR("alloc index");
+        return rc;
     }
-    memcpy(perm, permission, 1 + size);
 
     /*
      * ensure rooms for storing the fresh permission copy
      * allocation is made by block of 8 items
      */
     if ((permission_set->size & 7) == 0) {
-        size = (permission_set->size + 8) * sizeof * permission_set->permissions;
-        ptr = realloc(permission_set->permissions, size);
+        ptr = realloc(permission_set->permissions,
+                      (permission_set->size + 8) * sizeof * permission_set->permissions);
         if (ptr == NULL) {
-            free(perm);
             ERROR("realloc ptr");
             return -ENOMEM;
         }
         permission_set->permissions = ptr;
     }
+
+    /* get the shared copy of the permission */
+    perm = interned_get(permission);
+    if (perm == NULL) {
+        ERROR("intern perm");
+        return -ENOMEM;
+    }
     permission_set->permissions[permission_set->size++] = perm;
 
+    /* index it */
+    hash = hash_permission(perm);
+    slot = search_slot(permission_set, perm, hash);
+    slot->hash = hash;
+    slot->position = (uint32_t)permission_set->size;
+
     return 0;
 }
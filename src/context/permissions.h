@@ -28,8 +28,13 @@
  *
  */
 typedef struct permission_set {
-    char **permissions;
+    /** interned permissions, see interned.h */
+    const char **permissions;
     size_t size;
+    /** open addressing index of permissions, NULL when empty */
+    struct permission_slot *index;
+    /** count of slots of the index, a power of 2 */
+    size_t index_size;
 } permission_set_t;
 
 /**
@@ -71,4 +76,15 @@ extern int permission_set_add(permission_set_t *permission_set, const char *perm
 __nonnull() __wur
 extern bool permission_set_has(const permission_set_t *permission_set, const char *permission);
 
+/**
+ * @brief Get the position of the permission in the permission set,
+ * that is the count of permissions added before it
+ *
+ * @param[in] permission_set The permission_set handler
+ * @param[in] permission the permission to search
+ * @return the position of the permission or -ENOENT if not in the set
+ */
+__nonnull() __wur
+extern int permission_set_position(const permission_set_t *permission_set, const char *permission);
+
 #endif
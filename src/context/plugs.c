@@ -31,20 +31,22 @@
 #include "file-utils.h"
 #include "sizes.h"
 
-__nonnull()
-void plugset_init(plugset_t *plugset)
+__nonnull((1))
+void plugset_init(plugset_t *plugset, arena_t *arena)
 {
-    *plugset = NULL;
+    plugset->first = NULL;
+    plugset->arena = arena;
 }
 
 __nonnull()
 void plugset_clear(plugset_t *plugset)
 {
-    for (;;) {
-        plug_t *plug = *plugset;
-        if (plug == NULL)
-            return;
-        *plugset = plug->next;
+    plug_t *plug;
+
+    if (plugset->arena != NULL)
+        plugset->first = NULL;
+    while ((plug = plugset->first) != NULL) {
+        plugset->first = plug->next;
         free(plug);
     }
 }
@@ -67,7 +69,10 @@ int plugset_add(plugset_t *plugset, const char *expdir, const char *impid, const
         return -EINVAL;
 
     /* allocate the new plug structure */
-    plug = malloc(len_expdir + len_impid + len_impdir + 3 + sizeof *plug);
+    if (plugset->arena != NULL)
+        plug = arena_alloc(plugset->arena, len_expdir + len_impid + len_impdir + 3 + sizeof *plug);
+    else
+        plug = malloc(len_expdir + len_impid + len_impdir + 3 + sizeof *plug);
     if (plug == NULL)
         return -ENOMEM;
 
@@ -81,15 +86,15 @@ int plugset_add(plugset_t *plugset, const char *expdir, const char *impid, const
     mempcpy(ptr, impid, len_impid + 1);
 
     /* link the new plug structure in the set */
-    plug->next = *plugset;
-    *plugset = plug;
+    plug->next = plugset->first;
+    plugset->first = plug;
     return 0;
 }
 
 __wur __nonnull((1))
 static plug_t *search(plugset_t *plugset, const char *expdir, const char *impid, const char *impdir)
 {
-    plug_t *plug = *plugset;
+    plug_t *plug = plugset->first;
     while (plug != NULL
         && ((expdir != NULL && 0 != strcmp(plug->expdir, expdir))
          || (impid  != NULL && 0 != strcmp(plug->impid,  impid))
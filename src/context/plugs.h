@@ -28,6 +28,8 @@
 #include <stddef.h>
 #include <sys/cdefs.h>
 
+#include "arena.h"
+
 /**
  * @brief Structure of plug
  */
@@ -41,15 +43,19 @@ typedef struct plug {
 /**
  * @brief Structure of plugset
  */
-typedef plug_t *plugset_t;
+typedef struct plugset {
+    plug_t *first; /**< list of plugs, the last added first */
+    arena_t *arena; /**< arena of the plugs or NULL for the heap */
+} plugset_t;
 
 /**
- * @brief Initialize the fields 'size' and 'plugs'
+ * @brief Initialize the plugset
  *
  * @param[in] plugset plugset handler
+ * @param[in] arena arena where to allocate the plugs or NULL for the heap
  */
-__nonnull()
-extern void plugset_init(plugset_t *plugset);
+__nonnull((1))
+extern void plugset_init(plugset_t *plugset, arena_t *arena);
 
 /**
  * @brief Free plugs that have been added
@@ -33,9 +33,35 @@
 #include <fcntl.h>
 
 #include "log.h"
+#include "sizes.h"
 
 static const size_t BLOCKSIZE = 8192;
 
+/** suffix of the temporary files of write_file */
+static const char TEMPSUFFIX[] = ".XXXXXX";
+
+/**
+ * @brief Flush to disk the directory of the file of path
+ *
+ * @param[inout] path the path of the file, its last component is removed
+ */
+__nonnull()
+static void sync_directory(char *path)
+{
+    char *slash = strrchr(path, '/');
+    int fd;
+
+    if (slash == NULL)
+        strcpy(path, ".");
+    else
+        slash[slash == path] = '\0';
+    fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0 || (fsync(fd) < 0 && errno != EINVAL))
+        ERROR("sync directory %s : %d %s", path, errno, strerror(errno));
+    if (fd >= 0)
+        close(fd);
+}
+
 /**********************/
 /*** PUBLIC METHODS ***/
 /**********************/
@@ -144,6 +170,85 @@ end:
     return result;
 }
 
+/* see file-utils.h */
+int write_file(const char *path, const void *data, size_t size) {
+    const char *iter = data;
+    size_t len = strlen(path);
+    char temp[SEC_LSM_MANAGER_MAX_SIZE_PATH + sizeof TEMPSUFFIX];
+    struct stat s;
+    ssize_t wr;
+    int fd, rc;
+
+    if (len > SEC_LSM_MANAGER_MAX_SIZE_PATH) {
+        ERROR("path too long: %s", path);
+        return -ENAMETOOLONG;
+    }
+    memcpy(temp, path, len);
+    memcpy(&temp[len], TEMPSUFFIX, sizeof TEMPSUFFIX);
+    /* close on exec: helpers may be forked by other threads */
+    fd = mkostemp(temp, O_CLOEXEC);
+    if (fd < 0) {
+        rc = -errno;
+        ERROR("mkostemp %s : %d %s", temp, -rc, strerror(-rc));
+        return rc;
+    }
+
+    /* keep the mode of the replaced file, or the usual one */
+    rc = fchmod(fd, stat(path, &s) == 0 ? s.st_mode & 07777 : 0644);
+    if (rc < 0) {
+        rc = -errno;
+        ERROR("fchmod %s : %d %s", temp, -rc, strerror(-rc));
+        goto error;
+    }
+
+    /* write all at once, continuing only on short writes */
+    while (size) {
+        wr = write(fd, iter, size);
+        if (wr < 0) {
+            if (errno == EINTR)
+                continue;
+            rc = -errno;
+            ERROR("write %s : %d %s", temp, -rc, strerror(-rc));
+            goto error;
+        }
+        iter += wr;
+        size -= (size_t)wr;
+    }
+
+    /* the content must be on disk before the name, even after a power loss */
+    rc = fsync(fd);
+    if (rc < 0) {
+        rc = -errno;
+        ERROR("fsync %s : %d %s", temp, -rc, strerror(-rc));
+        goto error;
+    }
+
+    rc = close(fd);
+    fd = -1;
+    if (rc < 0) {
+        rc = -errno;
+        ERROR("close %s : %d %s", temp, -rc, strerror(-rc));
+        goto error;
+    }
+
+    rc = rename(temp, path);
+    if (rc < 0) {
+        rc = -errno;
+        ERROR("rename %s : %d %s", path, -rc, strerror(-rc));
+        goto error;
+    }
+
+    /* make the rename durable, the file is in place whatever happens */
+    sync_directory(temp);
+    return 0;
+
+error:
+    if (fd >= 0)
+        close(fd);
+    unlink(temp);
+    return rc;
+}
+
 /* see file-utils.h */
 __nonnull()
 int get_path_property(const char path[], bool follow)
@@ -63,6 +63,19 @@ extern int remove_file(const char *path) __wur __nonnull();
  */
 extern char *read_file(const char *path);
 
+/**
+ * @brief Replace the content of a file atomically. The content is written
+ * with one write to a temporary file of the same directory that is flushed
+ * to disk and then renamed to path. Readers, and the next boot after a
+ * power loss, see either the old or the new content.
+ *
+ * @param[in] path The path of the file
+ * @param[in] data The content to write
+ * @param[in] size The size of the content
+ * @return 0 in case of success or a negative -errno value
+ */
+extern int write_file(const char *path, const void *data, size_t size) __wur __nonnull();
+
 /**
  * @brief Get property of the path
  *
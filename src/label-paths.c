@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "label-paths.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "log.h"
+
+#if !defined(LABEL_PATHS_THREADS)
+#define LABEL_PATHS_THREADS 4
+#endif
+
+/** minimal count of paths labelled by each thread */
+#if !defined(LABEL_PATHS_PER_THREAD)
+#define LABEL_PATHS_PER_THREAD 64
+#endif
+
+/**
+ * state of a labelling shared by its threads
+ */
+typedef struct labelling {
+    /** the paths to label */
+    const path_set_t *path_set;
+    /** the callback labelling a path */
+    label_path_cb_t label;
+    /** the closure of the callback */
+    const void *closure;
+    /** protection of next, failed and rc */
+    pthread_mutex_t mutex;
+    /** index of the next path to label */
+    size_t next;
+    /** index of the first failing path or size of the set */
+    size_t failed;
+    /** error of the first failing path */
+    int rc;
+} labelling_t;
+
+/**
+ * @brief Label the paths not yet labelled until the end of the set or
+ * until a failing path. The paths are taken in order so that all the
+ * paths before a failing one are labelled.
+ *
+ * @param[in] arg the labelling
+ * @return NULL
+ */
+static void *labeller(void *arg)
+{
+    labelling_t *labelling = arg;
+    size_t idx;
+    int rc;
+
+    for (;;) {
+        pthread_mutex_lock(&labelling->mutex);
+        idx = labelling->next < labelling->failed ? labelling->next++ : SIZE_MAX;
+        pthread_mutex_unlock(&labelling->mutex);
+        if (idx == SIZE_MAX)
+            return NULL;
+
+        rc = labelling->label(labelling->path_set->paths[idx], labelling->closure);
+        if (rc < 0) {
+            pthread_mutex_lock(&labelling->mutex);
+            if (idx < labelling->failed) {
+                labelling->failed = idx;
+                labelling->rc = rc;
+            }
+            pthread_mutex_unlock(&labelling->mutex);
+        }
+    }
+}
+
+/**********************/
+/*** PUBLIC METHODS ***/
+/**********************/
+
+/* see label-paths.h */
+int label_paths(const path_set_t *path_set, label_path_cb_t label, const void *closure)
+{
+    pthread_t threads[LABEL_PATHS_THREADS > 1 ? LABEL_PATHS_THREADS - 1 : 1];
+    labelling_t labelling = {
+        .path_set = path_set,
+        .label = label,
+        .closure = closure,
+        .mutex = PTHREAD_MUTEX_INITIALIZER,
+        .next = 0,
+        .failed = path_set->size,
+        .rc = 0
+    };
+    size_t count, idx;
+    int rc;
+
+    /* count of threads, the calling one included */
+    count = (path_set->size + LABEL_PATHS_PER_THREAD - 1) / LABEL_PATHS_PER_THREAD;
+    if (count > LABEL_PATHS_THREADS)
+        count = LABEL_PATHS_THREADS;
+
+    /* start the other threads, the calling thread labels anyway */
+    for (idx = 0 ; idx + 1 < count ; idx++) {
+        rc = pthread_create(&threads[idx], NULL, labeller, &labelling);
+        if (rc != 0) {
+            ERROR("can't create labelling thread: %s", strerror(rc));
+            break;
+        }
+    }
+    labeller(&labelling);
+    while (idx > 0)
+        pthread_join(threads[--idx], NULL);
+
+    pthread_mutex_destroy(&labelling.mutex);
+    return labelling.rc;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_LABEL_PATHS_H
+#define SEC_LSM_MANAGER_LABEL_PATHS_H
+
+#include <sys/cdefs.h>
+
+#include "context/paths.h"
+
+/**
+ * @brief Callback labelling one path, called concurrently for distinct paths
+ *
+ * @param[in] path the path to label
+ * @param[in] closure the closure given to label_paths
+ * @return 0 in case of success or a negative -errno value
+ */
+typedef int (*label_path_cb_t)(const path_t *path, const void *closure);
+
+/**
+ * @brief Label the paths of the set. Large sets are shared between at most
+ * LABEL_PATHS_THREADS threads. As when labelling in order, the paths
+ * following a failing path might not be labelled and the result is the
+ * error of the first failing path of the set.
+ *
+ * @param[in] path_set the paths to label
+ * @param[in] label the callback labelling a path
+ * @param[in] closure the closure of the callback
+ * @return 0 in case of success or the error of the first failing path
+ */
+extern int label_paths(const path_set_t *path_set, label_path_cb_t label, const void *closure) __wur __nonnull((1, 2));
+
+#endif
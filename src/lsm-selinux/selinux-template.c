@@ -24,6 +24,7 @@
 #include "selinux-template.h"
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -71,6 +72,12 @@ const char default_selinux_rules_dir[] = SELINUX_RULES_DIR;
 const char default_selinux_te_template_file[] = SELINUX_TE_TEMPLATE_FILE;
 const char default_selinux_if_template_file[] = SELINUX_IF_TEMPLATE_FILE;
 
+#if WITH_BUILTIN_TEMPLATES
+/* the default templates compiled at build time (generated by template-gen) */
+extern template_builtin_t builtin_selinux_te_template;
+extern template_builtin_t builtin_selinux_if_template;
+#endif
+
 const char suffix_id[] = "_t";
 const char suffix_lib[] = "_lib_t";
 const char suffix_conf[] = "_conf_t";
@@ -80,6 +87,9 @@ const char suffix_data[] = "_data_t";
 const char suffix_http[] = "_http_t";
 const char public_app[] = "redpesk_public_t";
 
+/** serialisation of compilations that share the rules directory */
+static pthread_mutex_t compile_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /***********************/
 /*** PRIVATE METHODS ***/
 /***********************/
@@ -162,6 +172,23 @@ ret:
     return rc;
 }
 
+/**
+ * @brief Process the template, using its compiled form when it is a default one
+ *
+ * @param[in] template_file the template file
+ * @param[in] dest the file to write
+ * @param[in] context context handler
+ * @return 0 in case of success or a negative value
+ */
+__nonnull() __wur
+static int process_template(const char *template_file, const char *dest, const context_t *context) {
+    template_builtin_t *builtin = get_selinux_builtin_template(template_file);
+
+    if (builtin != NULL)
+        return template_process_builtin(builtin, dest, context);
+    return template_process(template_file, dest, context);
+}
+
 /**
  * @brief Generate te, if, fc files
  *
@@ -174,14 +201,14 @@ int generate_app_module_files(const selinux_module_t *selinux_module, const cont
                                          path_type_definitions_t path_type_definitions[number_path_type]) {
     int rc = 0;
     int rc2 = 0;
-    rc = template_process(selinux_module->selinux_te_template_file, selinux_module->selinux_te_file, context);
+    rc = process_template(selinux_module->selinux_te_template_file, selinux_module->selinux_te_file, context);
     if (rc < 0) {
         ERROR("template_process %s -> %s : %d %s", selinux_module->selinux_te_template_file,
               selinux_module->selinux_te_file, -rc, strerror(-rc));
         goto ret;
     }
 
-    rc = template_process(selinux_module->selinux_if_template_file, selinux_module->selinux_if_file, context);
+    rc = process_template(selinux_module->selinux_if_template_file, selinux_module->selinux_if_file, context);
     if (rc < 0) {
         ERROR("template_process %s -> %s : %d %s", selinux_module->selinux_if_template_file,
               selinux_module->selinux_if_file, -rc, strerror(-rc));
@@ -489,6 +516,19 @@ const char *get_selinux_if_template_file(const char *value) {
     return get_opt_env_def(value, "SELINUX_IF_TEMPLATE_FILE", default_selinux_if_template_file);
 }
 
+/* see selinux-template.h */
+template_builtin_t *get_selinux_builtin_template(const char *template_file) {
+#if WITH_BUILTIN_TEMPLATES
+    if (!strcmp(template_file, default_selinux_te_template_file))
+        return &builtin_selinux_te_template;
+    if (!strcmp(template_file, default_selinux_if_template_file))
+        return &builtin_selinux_if_template;
+#else
+    (void)template_file;
+#endif
+    return NULL;
+}
+
 /* see selinux-template.h */
 const char *get_selinux_rules_dir(const char *value) {
     return get_opt_env_def(value, "SELINUX_RULES_DIR", default_selinux_rules_dir);
@@ -541,7 +581,9 @@ int create_selinux_rules(const context_t *context,
     DEBUG("success generate selinux files module");
 
     // fc, if, te generated
+    pthread_mutex_lock(&compile_mutex);
     rc = launch_compile(context->id);
+    pthread_mutex_unlock(&compile_mutex);
     if (rc < 0) {
         ERROR("launch_compile : %d %s", -rc, strerror(-rc));
         goto error3;
@@ -25,6 +25,7 @@
 #define SEC_LSM_MANAGER_SELINUX_TEMPLATE_H
 
 #include "context/context.h"
+#include "templating/template-compile.h"
 
 #if SIMULATE_SELINUX
 #include "simulation/selinux/selinux.h"
@@ -54,6 +55,14 @@ extern const char *get_selinux_te_template_file(const char *value) __wur;
  */
 extern const char *get_selinux_if_template_file(const char *value) __wur;
 
+/**
+ * @brief Get the template compiled at build time replacing the template file
+ *
+ * @param[in] template_file the te or if template file
+ * @return the compiled template or NULL when the template file must be processed
+ */
+extern template_builtin_t *get_selinux_builtin_template(const char *template_file) __wur __nonnull();
+
 /**
  * @brief Get the selinux rules directory
  *
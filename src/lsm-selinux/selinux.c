@@ -32,7 +32,9 @@
 
 #include "log.h"
 #include "selinux-template.h"
+#include "templating/template.h"
 #include "file-utils.h"
+#include "label-paths.h"
 #include "xattr-selinux.h"
 
 #if WITH_SELINUX
@@ -48,6 +50,10 @@ int mac_uninstall(const context_t *context)
 __nonnull()
 void mac_get_label(char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1], const char *appid)
          __attribute__ ((alias ("selinux_get_label")));
+
+__wur
+int mac_reference_permissions(void)
+         __attribute__ ((alias ("selinux_reference_permissions")));
 #endif
 
 /**
@@ -89,6 +95,37 @@ __nonnull() __wur static int label_file(const char *path, const char *label) {
     return 0;
 }
 
+/**
+ * closure of label_path
+ */
+typedef struct {
+    /** the id of the application */
+    const char *id;
+    /** the definitions of the types of paths */
+    path_type_definitions_t *path_type_definitions;
+} label_path_closure_t;
+
+/**
+ * @brief Label a path, see label_paths
+ *
+ * @param[in] path the path
+ * @param[in] closure the label_path_closure_t
+ * @return 0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int label_path(const path_t *path, const void *closure) {
+    const label_path_closure_t *lpc = closure;
+    char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 3];
+
+    snprintf(label, SEC_LSM_MANAGER_MAX_SIZE_LABEL + 3, "%s:s0", lpc->path_type_definitions[path->path_type].label);
+    int rc = label_file(path->path, label);
+    if (rc < 0) {
+        ERROR("label_file((%s,%s),%s) : %d %s", path->path, path_type_name(path->path_type), lpc->id,
+              -rc, strerror(-rc));
+    }
+    return rc;
+}
+
 /**
  * @brief Apply selinux on a context
  *
@@ -97,20 +134,11 @@ __nonnull() __wur static int label_file(const char *path, const char *label) {
  */
 __nonnull() __wur int selinux_process_paths(const context_t *context,
                                             path_type_definitions_t path_type_definitions[number_path_type]) {
-    path_t *path = NULL;
-    char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 3];
-    for (size_t i = 0; i < context->path_set.size; i++) {
-        path = context->path_set.paths[i];
-        snprintf(label, SEC_LSM_MANAGER_MAX_SIZE_LABEL + 3, "%s:s0", path_type_definitions[path->path_type].label);
-        int rc = label_file(path->path, label);
-        if (rc < 0) {
-            ERROR("label_file((%s,%s),%s) : %d %s", path->path, path_type_name(path->path_type), context->id,
-                  -rc, strerror(-rc));
-            return rc;
-        }
-    }
-
-    return 0;
+    label_path_closure_t closure = {
+        .id = context->id,
+        .path_type_definitions = path_type_definitions
+    };
+    return label_paths(&context->path_set, label_path, &closure);
 }
 
 /**********************/
@@ -228,3 +256,29 @@ void selinux_get_label(char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1], const cha
     snprintf(label, SEC_LSM_MANAGER_MAX_SIZE_LABEL, "system_u:system_r:%s_t:s0", _id_);
     label[SEC_LSM_MANAGER_MAX_SIZE_ID] = '\0';
 }
+
+/**
+ * @brief Reference the permissions checked by the template, using its
+ * compiled form when it is a default one
+ *
+ * @param[in] template_file the template file
+ * @return 0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int reference_template(const char *template_file)
+{
+    template_builtin_t *builtin = get_selinux_builtin_template(template_file);
+
+    if (builtin != NULL)
+        return template_reference_builtin(builtin);
+    return template_reference_permissions(template_file);
+}
+
+/* see selinux.h */
+int selinux_reference_permissions(void)
+{
+    int rc = reference_template(get_selinux_te_template_file(NULL));
+    if (rc >= 0)
+        rc = reference_template(get_selinux_if_template_file(NULL));
+    return rc;
+}
@@ -60,6 +60,13 @@ extern int selinux_uninstall(const context_t *context) __wur __nonnull();
 __nonnull()
 extern void selinux_get_label(char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1], const char *appid);
 
+/**
+ * @brief Reference the permissions checked by the selinux templates
+ *
+ * @return 0 in case of success or a negative -errno value
+ */
+extern int selinux_reference_permissions(void) __wur;
+
 /************************ FOR TESTING ************************/
 #include "selinux-template.h"
 __nonnull() __wur
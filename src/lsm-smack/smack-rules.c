@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "smack-rules.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+
+/** the access of removed rules */
+static const char no_access[] = "-";
+
+/**
+ * @brief Compare the subject/object pairs of the rules
+ *
+ * @param[in] a first rule
+ * @param[in] b second rule
+ * @return an integer less than, equal to, or greater than zero like strcmp
+ */
+__nonnull() __wur
+static int compare_pair(const smack_rule_t *a, const smack_rule_t *b)
+{
+    int rc = strcmp(a->subject, b->subject);
+    return rc ? rc : strcmp(a->object, b->object);
+}
+
+/**
+ * @brief Compare pointers to rules of the same array for qsort, rules of
+ * the same pair staying in the order of the array
+ *
+ * @param[in] a pointer to the first reference
+ * @param[in] b pointer to the second reference
+ * @return an integer less than, equal to, or greater than zero
+ */
+__nonnull() __wur
+static int compare_ref(const void *a, const void *b)
+{
+    const smack_rule_t *ra = *(const smack_rule_t * const *)a;
+    const smack_rule_t *rb = *(const smack_rule_t * const *)b;
+    int rc = compare_pair(ra, rb);
+    return rc ? rc : ra < rb ? -1 : ra > rb;
+}
+
+/**
+ * @brief Check if two rules of the same pair are the same
+ *
+ * @param[in] a first rule
+ * @param[in] b second rule
+ * @return true when the same
+ */
+__nonnull() __wur
+static bool same_access(const smack_rule_t *a, const smack_rule_t *b)
+{
+    if (strcmp(a->access, b->access))
+        return false;
+    if (a->deny == NULL || b->deny == NULL)
+        return a->deny == b->deny;
+    return !strcmp(a->deny, b->deny);
+}
+
+/**
+ * @brief Sort references to the rules by subject/object pairs
+ *
+ * @param[in] rules the rules
+ * @param[in] count the count of rules
+ * @param[out] refs the sorted references, to be freed
+ * @return 0 in case of success or -ENOMEM
+ */
+__nonnull() __wur
+static int sort_refs(const smack_rule_t *rules, size_t count, const smack_rule_t ***refs)
+{
+    size_t i;
+    const smack_rule_t **array = malloc((count ? count : 1) * sizeof *array);
+    if (array == NULL)
+        return -ENOMEM;
+    for (i = 0 ; i < count ; i++)
+        array[i] = &rules[i];
+    qsort(array, count, sizeof *array, compare_ref);
+    *refs = array;
+    return 0;
+}
+
+/* see smack-rules.h */
+int smack_rules_parse(char *text, smack_rule_t **rules, size_t *count)
+{
+    char *line, *next, *save;
+    smack_rule_t *array, *rule;
+    size_t n = 1;
+
+    /* at most one rule per line */
+    for (line = text ; (line = strchr(line, '\n')) != NULL ; line++)
+        n++;
+    array = malloc(n * sizeof *array);
+    if (array == NULL)
+        return -ENOMEM;
+
+    for (n = 0, line = text ; *line ; line = next) {
+        next = strchr(line, '\n');
+        if (next != NULL)
+            *next++ = '\0';
+        else
+            next = line + strlen(line);
+        if (*line == '\0')
+            continue;
+
+        rule = &array[n];
+        rule->subject = strtok_r(line, " \t", &save);
+        rule->object = strtok_r(NULL, " \t", &save);
+        rule->access = strtok_r(NULL, " \t", &save);
+        rule->deny = strtok_r(NULL, " \t", &save);
+        if (rule->subject == NULL || rule->object == NULL || rule->access == NULL
+         || strtok_r(NULL, " \t", &save) != NULL) {
+            ERROR("invalid rule %zu: %s", n + 1, line);
+            free(array);
+            return -EINVAL;
+        }
+        n++;
+    }
+
+    *rules = array;
+    *count = n;
+    return 0;
+}
+
+/* see smack-rules.h */
+int smack_rules_delta(const smack_rule_t *previous, size_t nprevious,
+                      const smack_rule_t *rules, size_t count,
+                      smack_rule_t **delta, size_t *ndelta)
+{
+    const smack_rule_t **prefs = NULL, **refs = NULL;
+    smack_rule_t *array;
+    size_t ip, ir, ep, er, i, n = 0;
+    bool same, modify;
+    int cmp, rc;
+
+    /* at worst, each pair is removed and each rule is applied */
+    array = malloc((nprevious + 2 * count + 1) * sizeof *array);
+    rc = array == NULL ? -ENOMEM : sort_refs(previous, nprevious, &prefs);
+    if (rc >= 0)
+        rc = sort_refs(rules, count, &refs);
+    if (rc < 0) {
+        free(array);
+        goto end;
+    }
+
+    /* merge the rules sorted by pairs, ep and er ending the groups of a pair */
+    for (ip = ir = 0 ; ip < nprevious || ir < count ; ip = ep, ir = er) {
+        if (ip >= nprevious)
+            cmp = 1;
+        else if (ir >= count)
+            cmp = -1;
+        else
+            cmp = compare_pair(prefs[ip], refs[ir]);
+        for (ep = ip ; cmp <= 0 && ep < nprevious && !compare_pair(prefs[ep], prefs[ip]) ; ep++);
+        for (er = ir ; cmp >= 0 && er < count && !compare_pair(refs[er], refs[ir]) ; er++);
+
+        if (cmp < 0) {
+            /* pair removed */
+            array[n].subject = prefs[ip]->subject;
+            array[n].object = prefs[ip]->object;
+            array[n].access = no_access;
+            array[n++].deny = NULL;
+            continue;
+        }
+
+        same = cmp == 0 && ep - ip == er - ir;
+        modify = false;
+        for (i = 0 ; i < er - ir ; i++) {
+            same = same && same_access(prefs[ip + i], refs[ir + i]);
+            modify = modify || refs[ir + i]->deny != NULL;
+        }
+        if (same)
+            continue;
+
+        /* modifications start from no access as when loaded first */
+        if (cmp == 0 && modify) {
+            array[n].subject = refs[ir]->subject;
+            array[n].object = refs[ir]->object;
+            array[n].access = no_access;
+            array[n++].deny = NULL;
+        }
+        for (i = ir ; i < er ; i++)
+            array[n++] = *refs[i];
+    }
+
+    *delta = array;
+    *ndelta = n;
+end:
+    free(prefs);
+    free(refs);
+    return rc;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_SMACK_RULES_H
+#define SEC_LSM_MANAGER_SMACK_RULES_H
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+/**
+ * A rule of a smack rules file: "SUBJECT OBJECT ACCESS [DENY]"
+ */
+typedef struct smack_rule {
+    /** the subject label */
+    const char *subject;
+    /** the object label */
+    const char *object;
+    /** the access, "-" for no access */
+    const char *access;
+    /** NULL or the access removed when the rule modifies the access */
+    const char *deny;
+} smack_rule_t;
+
+/**
+ * @brief Parse the rules of the text the same way as smack_accesses_add_from_file:
+ * one rule per line, empty lines being ignored
+ *
+ * @param[in] text the text of the rules, modified by the parsing
+ * @param[out] rules the rules, pointing in text, to be freed
+ * @param[out] count the count of rules
+ * @return 0 in case of success or a negative -errno value
+ */
+extern int smack_rules_parse(char *text, smack_rule_t **rules, size_t *count) __wur __nonnull();
+
+/**
+ * @brief Compute the rules changing the previous rules to the new ones.
+ * The subject/object pairs whose rules are the same are skipped, the pairs
+ * no more present get the access "-" and the other pairs get their new rules,
+ * preceded by the access "-" when they modify the access.
+ *
+ * @param[in] previous the previous rules
+ * @param[in] nprevious the count of previous rules
+ * @param[in] rules the new rules
+ * @param[in] count the count of new rules
+ * @param[out] delta the rules to apply, pointing to the strings of the rules, to be freed
+ * @param[out] ndelta the count of rules to apply
+ * @return 0 in case of success or a negative -errno value
+ */
+extern int smack_rules_delta(const smack_rule_t *previous, size_t nprevious,
+                             const smack_rule_t *rules, size_t count,
+                             smack_rule_t **delta, size_t *ndelta) __wur __nonnull((5, 6));
+
+#endif
@@ -38,6 +38,7 @@
 #endif
 
 #include "log.h"
+#include "smack-rules.h"
 #include "templating/template.h"
 #include "file-utils.h"
 
@@ -76,6 +77,11 @@
 const char default_smack_template_file[] = SMACK_TEMPLATE_FILE;
 const char default_smack_policy_dir[] = SMACK_POLICY_DIR;
 
+#if WITH_BUILTIN_TEMPLATES
+/* the default template compiled at build time (generated by template-gen) */
+extern template_builtin_t builtin_smack_template;
+#endif
+
 static const struct {
     const char *label;
     bool exec;
@@ -99,6 +105,32 @@ static const struct {
 /*** PRIVATE METHODS ***/
 /***********************/
 
+/**
+ * @brief Add the rules to the accesses
+ *
+ * @param[in] smack_accesses the accesses receiving the rules
+ * @param[in] rules the rules
+ * @param[in] count the count of rules
+ * @return 0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int add_rules(struct smack_accesses *smack_accesses, const smack_rule_t *rules, size_t count) {
+    const smack_rule_t *rule;
+    int rc;
+
+    for (rule = rules ; rule < &rules[count] ; rule++) {
+        if (rule->deny == NULL)
+            rc = smack_accesses_add(smack_accesses, rule->subject, rule->object, rule->access);
+        else
+            rc = smack_accesses_add_modify(smack_accesses, rule->subject, rule->object, rule->access, rule->deny);
+        if (rc < 0) {
+            ERROR("smack_accesses_add %s %s %s", rule->subject, rule->object, rule->access);
+            return -EINVAL;
+        }
+    }
+    return 0;
+}
+
 /**
  * @brief Remove file and loaded rules
  *
@@ -196,6 +228,17 @@ void init_path_type_definitions(path_type_definitions_t path_type_definitions[nu
     }
 }
 
+/* see smack-template.h */
+template_builtin_t *get_smack_builtin_template(const char *template_file) {
+#if WITH_BUILTIN_TEMPLATES
+    if (!strcmp(template_file, default_smack_template_file))
+        return &builtin_smack_template;
+#else
+    (void)template_file;
+#endif
+    return NULL;
+}
+
 /* see smack-template.h */
 int create_smack_rules(const context_t *context) {
     int rc = 0;
@@ -203,6 +246,10 @@ int create_smack_rules(const context_t *context) {
     struct smack_accesses *smack_accesses = NULL;
     char smack_rules_file[SEC_LSM_MANAGER_MAX_SIZE_PATH + 1];
     const char *smack_template_file;
+    template_builtin_t *builtin;
+    char *text = NULL, *previous_text = NULL;
+    size_t length, count, nprevious, ndelta;
+    smack_rule_t *rules = NULL, *previous = NULL, *delta = NULL;
 
     rc = get_smack_rule_path(smack_rules_file, context->id);
     if (rc < 0) {
@@ -210,52 +257,80 @@ int create_smack_rules(const context_t *context) {
         goto end;
     }
 
+    /* render the rules in memory */
     smack_template_file = get_smack_template_file(NULL);
-    rc = template_process(smack_template_file, smack_rules_file, context);
+    builtin = get_smack_builtin_template(smack_template_file);
+    if (builtin != NULL)
+        rc = template_render_builtin(builtin, context, &text, &length);
+    else
+        rc = template_render(smack_template_file, context, &text, &length);
     if (rc < 0) {
-        ERROR("template_process : %d %s", -rc, strerror(-rc));
+        ERROR("template_render : %d %s", -rc, strerror(-rc));
         goto end;
     }
 
-    int fd = open(smack_rules_file, O_RDONLY);
-    if (fd < 0) {
-        rc = -errno;
-        ERROR("open file %s : %d %s", smack_rules_file, -rc, strerror(-rc));
+    /* the rules of a previous installation, if any, are the loaded ones */
+    if (access(smack_rules_file, F_OK) == 0)
+        previous_text = read_file(smack_rules_file);
+
+    rc = write_file(smack_rules_file, text, length);
+    if (rc < 0) {
+        ERROR("write_file %s : %d %s", smack_rules_file, -rc, strerror(-rc));
+        goto end;
+    }
+
+    /* the rules are taken from the rendered text, not read back from the file */
+    rc = smack_rules_parse(text, &rules, &count);
+    if (rc < 0) {
+        ERROR("smack_rules_parse %s : %d %s", smack_rules_file, -rc, strerror(-rc));
         goto error;
     }
 
+    /* only the changes are loaded when reinstalling */
+    ndelta = count;
+    if (previous_text != NULL && smack_rules_parse(previous_text, &previous, &nprevious) >= 0) {
+        rc = smack_rules_delta(previous, nprevious, rules, count, &delta, &ndelta);
+        if (rc < 0) {
+            ERROR("smack_rules_delta %s : %d %s", smack_rules_file, -rc, strerror(-rc));
+            goto error;
+        }
+        DEBUG("create_smack_rules %s: %zu changes for %zu rules", context->id, ndelta, count);
+    }
+
     rc = smack_accesses_new(&smack_accesses);
     if (rc < 0) {
         ERROR("smack_accesses_new");
-        goto error2;
+        goto error;
     }
 
-    rc = smack_accesses_add_from_file(smack_accesses, fd);
+    rc = add_rules(smack_accesses, delta != NULL ? delta : rules, ndelta);
     if (rc < 0) {
-        ERROR("smack_accesses_add_from_file");
-        goto error2;
+        ERROR("add_rules %s : %d %s", smack_rules_file, -rc, strerror(-rc));
+        goto error;
     }
 
     if (smack_enabled()) {
         rc = smack_accesses_apply(smack_accesses);
         if (rc < 0) {
             ERROR("smack_accesses_apply");
-            goto error2;
+            goto error;
         }
     }
 
     DEBUG("create_smack_rules success");
-    close(fd);
     goto end;
 
-error2:
-    close(fd);
 error:
     rc2 = remove(smack_rules_file);
     if (rc2 < 0) {
         ERROR("remove %s : %d %s", smack_rules_file, errno, strerror(errno));
     }
 end:
+    free(delta);
+    free(previous);
+    free(rules);
+    free(previous_text);
+    free(text);
     smack_accesses_free(smack_accesses);
     smack_accesses = NULL;
     return rc;
@@ -27,6 +27,7 @@
 #include <sys/cdefs.h>
 
 #include "context/context.h"
+#include "templating/template-compile.h"
 
 typedef struct path_type_definitions {
     char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL];
@@ -42,6 +43,14 @@ typedef struct path_type_definitions {
  */
 extern const char *get_smack_template_file(const char *value) __wur;
 
+/**
+ * @brief Get the template compiled at build time replacing the template file
+ *
+ * @param[in] template_file the template file
+ * @return the compiled template or NULL when the template file must be processed
+ */
+extern template_builtin_t *get_smack_builtin_template(const char *template_file) __wur __nonnull();
+
 /**
  * @brief Get the smack policy directory
  *
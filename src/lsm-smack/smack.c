@@ -33,7 +33,9 @@
 
 #include "log.h"
 #include "smack-template.h"
+#include "templating/template.h"
 #include "file-utils.h"
+#include "label-paths.h"
 #include "xattr-smack.h"
 
 #define DROP_LABEL "User:Home"
@@ -51,6 +53,10 @@ int mac_uninstall(const context_t *context)
 __nonnull()
 void mac_get_label(char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1], const char *appid)
          __attribute__ ((alias ("smack_get_label")));
+
+__wur
+int mac_reference_permissions(void)
+         __attribute__ ((alias ("smack_reference_permissions")));
 #endif
 
 /***********************/
@@ -144,48 +150,88 @@ int smack_set_path_labels(const char *path, const char *label, const char *execl
     return rc;
 }
 
+/**
+ * closure of label_path
+ */
+typedef struct {
+    /** the id of the application */
+    const char *id;
+    /** the definitions of the types of paths */
+    path_type_definitions_t *path_type_definitions;
+    /** the label for executables */
+    const char *exec_label;
+    /** true for setting the labels, false for removing them */
+    bool set;
+} label_path_closure_t;
+
+/**
+ * @brief Set or remove smack labels of a path, see label_paths
+ *
+ * @param[in] path the path
+ * @param[in] closure the label_path_closure_t
+ * @return 0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int label_path(const path_t *path, const void *closure)
+{
+    const label_path_closure_t *lpc = closure;
+    path_type_definitions_t *def = &lpc->path_type_definitions[path->path_type];
+    int rc, pp;
+
+    pp = get_path_property(path->path, false);
+    DEBUG("labbelling %s pp=%d", path->path, pp);
+    if (pp < 0)
+        rc = pp;
+    else if (!lpc->set)
+        rc = unset_path_labels(path->path);
+    else
+        rc = smack_set_path_labels(path->path,
+                             def->label,
+                             (pp == PATH_FILE_EXEC) && def->is_executable ? lpc->exec_label : NULL,
+                             (pp == PATH_DIRECTORY) && def->is_transmute);
+    if (rc < 0)
+        ERROR("%sset_path_labels(%s,%s,%s): %d %s", lpc->set ? "" : "un", path->path,
+                                def->label, lpc->id, -rc, strerror(-rc));
+    return rc;
+}
+
 /**
  * @brief Set smack labels for context
  *
  * @param[in] context context handler
+ * @param[in] set true for setting the labels, false for removing them
  * @return 0 in case of success or a negative -errno value
  */
 __nonnull() __wur
 static int label_all_paths(const context_t *context, bool set)
 {
-    size_t i;
-    int pp, rc = 0;
-    path_t *path;
     path_type_definitions_t path_type_definitions[number_path_type];
-    path_type_definitions_t *def;
-    const char *exec_label;
+    label_path_closure_t closure = {
+        .id = context->id,
+        .path_type_definitions = path_type_definitions,
+        .exec_label = path_type_definitions[type_id].label,
+        .set = set
+    };
 
     init_path_type_definitions(path_type_definitions, context->id);
-    exec_label = path_type_definitions[type_id].label;
-    for (i = 0; i < context->path_set.size; i++) {
-
-        path = context->path_set.paths[i];
-        def = &path_type_definitions[path->path_type];
-
-        pp = get_path_property(path->path, false);
-        DEBUG("labbelling %s pp=%d", path->path, pp);
-        if (pp < 0)
-            rc = pp;
-        else if (!set)
-            rc = unset_path_labels(path->path);
-        else
-            rc = smack_set_path_labels(path->path,
-                                 def->label,
-                                 (pp == PATH_FILE_EXEC) && def->is_executable ? exec_label : NULL,
-                                 (pp == PATH_DIRECTORY) && def->is_transmute);
-        if (rc < 0) {
-            ERROR("%sset_path_labels(%s,%s,%s): %d %s", set ? "" : "un", path->path,
-                                    def->label, context->id, -rc, strerror(-rc));
-            return rc;
-        }
-    }
+    return label_paths(&context->path_set, label_path, &closure);
+}
 
-    return 0;
+/**
+ * @brief Set the drop label to a path, see label_paths
+ *
+ * @param[in] path the path
+ * @param[in] closure the id of the application
+ * @return 0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int drop_path_label(const path_t *path, const void *closure)
+{
+    int rc = smack_set_path_labels(path->path, DROP_LABEL, NULL, false);
+    if (rc < 0)
+        ERROR("smack_set_path_labels((%s,%s),%s) : %d %s", path->path,
+              path_type_name(path->path_type), (const char *)closure, -rc, strerror(-rc));
+    return rc;
 }
 
 /**
@@ -196,19 +242,7 @@ static int label_all_paths(const context_t *context, bool set)
  */
 __nonnull() __wur
 static int smack_drop_path_labels(const context_t *context) {
-    int rc = 0;
-    path_t *path = NULL;
-    for (size_t i = 0; i < context->path_set.size; i++) {
-        path = context->path_set.paths[i];
-        rc = smack_set_path_labels(path->path, DROP_LABEL, NULL, false);
-        if (rc < 0) {
-            ERROR("smack_set_path_labels((%s,%s),%s) : %d %s", context->path_set.paths[i]->path,
-                  path_type_name(context->path_set.paths[i]->path_type), context->id, -rc, strerror(-rc));
-            return rc;
-        }
-    }
-
-    return 0;
+    return label_paths(&context->path_set, drop_path_label, context->id);
 }
 
 /**
@@ -225,7 +259,7 @@ static int install_smack_plugs(const context_t *context)
     plug_t *plugit;
     int rc2, rc = 0;
 
-    for (plugit = context->plugset ; plugit != NULL ; plugit = plugit->next) {
+    for (plugit = context->plugset.first ; plugit != NULL ; plugit = plugit->next) {
         rc2 = snprintf(buffer, sizeof buffer, "%s/%s", plugit->impdir, context->id);
         if (rc2 > PATH_MAX)
             rc2 = -ENAMETOOLONG;
@@ -264,7 +298,7 @@ static int uninstall_smack_plugs(const context_t *context)
     plug_t *plugit;
     int rc2, rc = 0;
 
-    for (plugit = context->plugset ; plugit != NULL ; plugit = plugit->next) {
+    for (plugit = context->plugset.first ; plugit != NULL ; plugit = plugit->next) {
         rc2 = snprintf(buffer, sizeof buffer, "%s/%s", plugit->impdir, context->id);
         if (rc2 > PATH_MAX)
             rc2 = -ENAMETOOLONG;
@@ -404,3 +438,14 @@ void smack_get_label(char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1], const char
     snprintf(label, SEC_LSM_MANAGER_MAX_SIZE_LABEL, "App:%s", appid);
     label[SEC_LSM_MANAGER_MAX_SIZE_ID] = '\0';
 }
+
+/* see smack.h */
+int smack_reference_permissions(void)
+{
+    const char *template_file = get_smack_template_file(NULL);
+    template_builtin_t *builtin = get_smack_builtin_template(template_file);
+
+    if (builtin != NULL)
+        return template_reference_builtin(builtin);
+    return template_reference_permissions(template_file);
+}
@@ -52,6 +52,13 @@ extern int smack_uninstall(const context_t *context) __wur __nonnull();
 __nonnull()
 extern void smack_get_label(char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL + 1], const char *appid);
 
+/**
+ * @brief Reference the permissions checked by the smack template
+ *
+ * @return 0 in case of success or a negative -errno value
+ */
+extern int smack_reference_permissions(void) __wur;
+
 /************************ FOR TESTING ************************/
 __nonnull((1, 2)) __wur int smack_set_path_labels(const char *path, const char *label, const char *execlabel, bool transmute);
 
@@ -25,6 +25,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <limits.h>
 #include <poll.h>
 #include <signal.h>
 #include <stddef.h>
@@ -148,10 +149,33 @@ static const char help_permission_text[] =
 
 static const char help_install_text[] =
     "\n"
-    "Command: install\n"
+    "Command: install [async]\n"
     "\n"
     "Install application\n"
     "WARNING : You need to set id before\n"
+    "\n"
+    "With the 'async' argument, the install is started and its\n"
+    "ticket is printed without waiting the completion. The current\n"
+    "application is then cleared.\n"
+    "\n";
+
+static const char help_wait_text[] =
+    "\n"
+    "Command: wait ticket\n"
+    "\n"
+    "Wait the completion of the install of the ticket\n"
+    "\n"
+    "Example : wait 1\n"
+    "\n";
+
+static const char help_status_text[] =
+    "\n"
+    "Command: status ticket\n"
+    "\n"
+    "Print the status of the install of the ticket:\n"
+    "pending, installed or failed\n"
+    "\n"
+    "Example : status 1\n"
     "\n";
 
 static const char help_uninstall_text[] =
@@ -162,13 +186,40 @@ static const char help_uninstall_text[] =
     "WARNING : You need to set id before\n"
     "\n";
 
+static const char help_batch_text[] =
+    "\n"
+    "Command: batch\n"
+    "\n"
+    "Start a batch: the following commands id, path, plug, permission\n"
+    "and clear are sent without waiting their replies until commit\n"
+    "\n";
+
+static const char help_manifest_text[] =
+    "\n"
+    "Command: manifest\n"
+    "\n"
+    "Start a manifest: the following commands id, path, plug and permission\n"
+    "are recorded in a manifest sent in one request by commit, clear\n"
+    "restarts the manifest\n"
+    "\n";
+
+static const char help_commit_text[] =
+    "\n"
+    "Command: commit\n"
+    "\n"
+    "Send the commands of the batch, wait their replies and print\n"
+    "the errors with the index of the failing command in the batch\n"
+    "or send the manifest\n"
+    "\n";
+
 static const char help__text[] =
     "\n"
     "Type 'help command' to get help on the command\n"
     "Example 'help log' to get help on log\n"
     "\n"
     "Commands are: log, clear, display, id, path, plug, permission,\n"
-    "              install, uninstall, quit, reset, help\n"
+    "              install, wait, status, uninstall, batch, manifest,\n"
+    "              commit, quit, reset, help\n"
     "\n";
 
 static const char help_reset_text[] =
@@ -193,7 +244,8 @@ static const char help_help_text[] =
     "Gives help on the command.\n"
     "\n"
     "Available commands: log, clear, display, id, path, permission,\n"
-    "                    install, uninstall, quit, reset, help\n"
+    "                    install, wait, status, uninstall, batch, manifest,\n"
+    "                    commit, quit, reset, help\n"
     "\n";
 
 static sec_lsm_manager_t *sec_lsm_manager = NULL;
@@ -203,6 +255,7 @@ static size_t bufill = 0;
 static int nstr = 0;
 static int echo = 0;
 static int last_status = 0;
+static int manifest_started = 0;
 
 static void _exit_(int status)
 {
@@ -393,7 +446,9 @@ static int do_permission(int ac, char **av) {
 
 static int do_install(int ac, char **av) {
     int used_count, rc;
-    int n = plink(ac, av, &used_count, 1);
+    unsigned ticket;
+    char text[20];
+    int n = plink(ac, av, &used_count, 2);
 
     if (n < 1) {
         ERROR("not enough arguments");
@@ -401,8 +456,65 @@ static int do_install(int ac, char **av) {
         return used_count;
     }
 
-    rc = sec_lsm_manager_install(sec_lsm_manager);
-    return show_status(used_count, "install", rc, NULL);
+    if (n < 2) {
+        rc = sec_lsm_manager_install(sec_lsm_manager);
+        return show_status(used_count, "install", rc, NULL);
+    }
+
+    if (strcmp(av[1], "async")) {
+        ERROR("bad argument %s", av[1]);
+        last_status = -EINVAL;
+        return used_count;
+    }
+
+    rc = sec_lsm_manager_install_async(sec_lsm_manager, &ticket);
+    snprintf(text, sizeof text, "%u", rc >= 0 ? ticket : 0);
+    return show_status(used_count, "install", rc, text);
+}
+
+static int get_ticket(int ac, char **av, int *used_count, unsigned *ticket) {
+    char *end;
+    unsigned long value;
+    int n = plink(ac, av, used_count, 2);
+
+    if (n < 2) {
+        ERROR("not enough arguments");
+        last_status = -EINVAL;
+        return 0;
+    }
+
+    value = strtoul(av[1], &end, 10);
+    if (*end != '\0' || value == 0 || value > UINT_MAX) {
+        ERROR("bad argument %s", av[1]);
+        last_status = -EINVAL;
+        return 0;
+    }
+
+    *ticket = (unsigned)value;
+    return 1;
+}
+
+static int do_wait(int ac, char **av) {
+    int used_count, rc;
+    unsigned ticket;
+
+    if (!get_ticket(ac, av, &used_count, &ticket))
+        return used_count;
+
+    rc = sec_lsm_manager_wait(sec_lsm_manager, ticket);
+    return show_status(used_count, "wait", rc, NULL);
+}
+
+static int do_status(int ac, char **av) {
+    static const char *status_texts[] = { "pending", "installed", "failed" };
+    int used_count, rc;
+    unsigned ticket;
+
+    if (!get_ticket(ac, av, &used_count, &ticket))
+        return used_count;
+
+    rc = sec_lsm_manager_status(sec_lsm_manager, ticket);
+    return show_status(used_count, "status", rc, rc >= 0 && rc <= 2 ? status_texts[rc] : NULL);
 }
 
 static int do_uninstall(int ac, char **av) {
@@ -419,6 +531,66 @@ static int do_uninstall(int ac, char **av) {
     return show_status(used_count, "uninstall", rc, NULL);
 }
 
+static void batch_error_callback(void *closure, unsigned index, int count, const char *fields[])
+{
+    (void)closure;
+    LOG("batch item %u, error: %s", index, count > 0 ? fields[0] : "?");
+}
+
+static int do_batch(int ac, char **av) {
+    int used_count, rc;
+    int n = plink(ac, av, &used_count, 1);
+
+    if (n < 1) {
+        ERROR("not enough arguments");
+        last_status = -EINVAL;
+        return used_count;
+    }
+
+    rc = sec_lsm_manager_batch_begin(sec_lsm_manager, batch_error_callback, NULL);
+    return show_status(used_count, "batch", rc, NULL);
+}
+
+static int do_manifest(int ac, char **av) {
+    int used_count, rc;
+    int n = plink(ac, av, &used_count, 1);
+
+    if (n < 1) {
+        ERROR("not enough arguments");
+        last_status = -EINVAL;
+        return used_count;
+    }
+
+    rc = sec_lsm_manager_manifest_begin(sec_lsm_manager);
+    manifest_started = rc >= 0;
+    return show_status(used_count, "manifest", rc, NULL);
+}
+
+static int do_commit(int ac, char **av) {
+    int used_count, rc;
+    int n = plink(ac, av, &used_count, 1);
+
+    if (n < 1) {
+        ERROR("not enough arguments");
+        last_status = -EINVAL;
+        return used_count;
+    }
+
+    if (manifest_started) {
+        manifest_started = 0;
+        rc = sec_lsm_manager_manifest_commit(sec_lsm_manager);
+        return show_status(used_count, "commit", rc, NULL);
+    }
+
+    rc = sec_lsm_manager_batch_commit(sec_lsm_manager);
+    if (rc > 0) {
+        LOG("commit, error: %d failed", rc);
+        last_status = -ECANCELED;
+        return used_count;
+    }
+    return show_status(used_count, "commit", rc, NULL);
+}
+
 static int do_reset(int ac, char **av) {
     int used_count;
     int n = plink(ac, av, &used_count, 1);
@@ -474,8 +646,18 @@ static int do_help(int ac, char **av) {
         help = help_permission_text;
     else if (ac > 1 && !strcmp(av[1], "install"))
         help = help_install_text;
+    else if (ac > 1 && !strcmp(av[1], "wait"))
+        help = help_wait_text;
+    else if (ac > 1 && !strcmp(av[1], "status"))
+        help = help_status_text;
     else if (ac > 1 && !strcmp(av[1], "uninstall"))
         help = help_uninstall_text;
+    else if (ac > 1 && !strcmp(av[1], "batch"))
+        help = help_batch_text;
+    else if (ac > 1 && !strcmp(av[1], "manifest"))
+        help = help_manifest_text;
+    else if (ac > 1 && !strcmp(av[1], "commit"))
+        help = help_commit_text;
     else if (ac > 1 && !strcmp(av[1], "reset"))
         help = help_reset_text;
     else
@@ -516,9 +698,24 @@ static int do_any(int ac, char **av) {
     if (!strcmp(av[0], "install"))
         return do_install(ac, av);
 
+    if (!strcmp(av[0], "wait"))
+        return do_wait(ac, av);
+
+    if (!strcmp(av[0], "status"))
+        return do_status(ac, av);
+
     if (!strcmp(av[0], "uninstall"))
         return do_uninstall(ac, av);
 
+    if (!strcmp(av[0], "batch"))
+        return do_batch(ac, av);
+
+    if (!strcmp(av[0], "manifest"))
+        return do_manifest(ac, av);
+
+    if (!strcmp(av[0], "commit"))
+        return do_commit(ac, av);
+
     if (!strcmp(av[0], "reset"))
         return do_reset(ac, av);
 
@@ -42,6 +42,7 @@
 #include <systemd/sd-daemon.h>
 #endif
 
+#include "action/mac-interface.h"
 #include "protocol/sec-lsm-manager-protocol.h"
 #include "protocol/sec-lsm-manager-server.h"
 #include "offline.h"
@@ -58,6 +59,10 @@
 #define SHUTOFF_TIME (60 * 3) /* 3 minutes */
 #endif
 
+#if !defined(WORKER_COUNT)
+#define WORKER_COUNT 1
+#endif
+
 #if !defined(SUPL_GROUPS_MAX)
 #define SUPL_GROUPS_MAX 10
 #endif
@@ -67,11 +72,13 @@
 #define CAP_COUNT (sizeof cap_vector / sizeof cap_vector[0])
 
 #define _OFFLINE_ '\001'
+#define _EDGETRIG_ '\002'
 #define _GROUP_ 'g'
 #define _GROUPS_ 'G'
 #define _HELP_ 'h'
 #define _KEEPGOING_ 'k'
 #define _LOG_ 'l'
+#define _MAXCLIENTS_ 'm'
 #define _MAKESOCKDIR_ 'M'
 #define _OWNSOCKDIR_ 'O'
 #define _OWNDBDIR_ 'o'
@@ -79,21 +86,25 @@
 #define _SHUTOFF_ 's'
 #define _USER_ 'u'
 #define _VERSION_ 'v'
+#define _WORKERS_ 'w'
 
-static const char shortopts[] = "d:g:G:hklMOoS:s:u:v";
+static const char shortopts[] = "d:g:G:hklm:MOoS:s:u:vw:";
 
 static const struct option longopts[] = {{"group", 1, NULL, _GROUP_},
                                          {"groups", 1, NULL, _GROUPS_},
+                                         {"edge-triggered", 0, NULL, _EDGETRIG_},
                                          {"help", 0, NULL, _HELP_},
                                          {"keep-going", 0, NULL, _KEEPGOING_},
                                          {"log", 0, NULL, _LOG_},
                                          {"make-socket-dir", 0, NULL, _MAKESOCKDIR_},
+                                         {"max-clients", 1, NULL, _MAXCLIENTS_},
                                          {"offline", 0, NULL, _OFFLINE_},
                                          {"own-socket-dir", 0, NULL, _OWNSOCKDIR_},
                                          {"shutoff", 1, NULL, _SHUTOFF_ },
                                          {"socketdir", 1, NULL, _SOCKETDIR_},
                                          {"user", 1, NULL, _USER_},
                                          {"version", 0, NULL, _VERSION_},
+                                         {"workers", 1, NULL, _WORKERS_},
                                          {NULL, 0, NULL, 0}};
 
 static const char helptxt[] =
@@ -107,7 +118,10 @@ static const char helptxt[] =
     "    -l, --log             activate log of transactions\n"
     "    -k, --keep-going      continue to run on some errors\n"
     "    -s, --shutoff VALUE   shutting off time in seconds\n"
+    "    -m, --max-clients N   maximum count of simultaneous clients\n"
+    "    -w, --workers N       count of threads for installing (default: %d)\n"
     "        --offline         offline operation\n"
+    "        --edge-triggered  poll clients in edge triggered mode\n"
     "\n"
     "    -S, --socketdir xxx   set the base directory xxx for sockets\n"
     "                            (default: %s)\n"
@@ -143,6 +157,7 @@ int main(int ac, char **av) {
     int makesockdir = 0;
     int ownsockdir = 0;
     int flog = 0;
+    int edgetrig = 0;
     int keepgoing = 0;
     int help = 0;
     int version = 0;
@@ -152,7 +167,11 @@ int main(int ac, char **av) {
     int gid = -1;
     int g;
     int soff = SHUTOFF_TIME;
+    int maxcli = 0; /* default */
+    int nrwork = WORKER_COUNT;
     const char *shutoff = NULL;
+    const char *maxclients = NULL;
+    const char *workers = NULL;
     const char *socketdir = NULL;
     const char *user = NULL;
     const char *group = NULL;
@@ -200,9 +219,15 @@ int main(int ac, char **av) {
             case _LOG_:
                 flog = 1;
                 break;
+            case _MAXCLIENTS_:
+                maxclients = optarg;
+                break;
             case _MAKESOCKDIR_:
                 makesockdir = 1;
                 break;
+            case _EDGETRIG_:
+                edgetrig = 1;
+                break;
             case _OFFLINE_:
                 offli = 1;
                 break;
@@ -218,6 +243,9 @@ int main(int ac, char **av) {
             case _USER_:
                 user = optarg;
                 break;
+            case _WORKERS_:
+                workers = optarg;
+                break;
             case _VERSION_:
                 version = 1;
                 break;
@@ -229,7 +257,7 @@ int main(int ac, char **av) {
 
     /* handles help, version, error */
     if (help) {
-        fprintf(stdout, helptxt, sec_lsm_manager_default_socket_dir);
+        fprintf(stdout, helptxt, WORKER_COUNT, sec_lsm_manager_default_socket_dir);
         return 0;
     }
     if (version) {
@@ -258,6 +286,24 @@ int main(int ac, char **av) {
         }
     }
 
+    /* compute maximum count of clients */
+    if (maxclients != NULL) {
+        maxcli = isid(maxclients);
+        if (maxcli <= 0) {
+            fprintf(stderr, "not a valid count of clients '%s'\n", maxclients);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* compute count of workers */
+    if (workers != NULL) {
+        nrwork = isid(workers);
+        if (nrwork < 0) {
+            fprintf(stderr, "not a valid count of workers '%s'\n", workers);
+            return EXIT_FAILURE;
+        }
+    }
+
     /* compute socket specs */
     spec_socket = 0;
 #if WITH_SYSTEMD
@@ -390,6 +436,7 @@ int main(int ac, char **av) {
     /* initialize server */
     setvbuf(stderr, NULL, _IOLBF, 1000);
     sec_lsm_manager_server_log = (bool)flog;
+    sec_lsm_manager_server_edge_triggered = (bool)edgetrig;
 
 #if DEBUG_MODE
     puts("DEBUG_MODE = 1");
@@ -401,16 +448,26 @@ int main(int ac, char **av) {
     signal(SIGUSR1, leavecov);
 #endif
 
+    /* give bits to the permissions checked by the templates */
+    rc = mac_reference_permissions();
+    if (rc < 0)
+        fprintf(stderr, "can't reference permissions of templates: %s\n", strerror(-rc));
+
     /* offline? */
     if (offli)
         offline();
 
     /* create server */
-    rc = sec_lsm_manager_server_create(&server, spec_socket);
+    rc = sec_lsm_manager_server_create(&server, spec_socket, (unsigned)maxcli);
     if (rc < 0) {
         fprintf(stderr, "can't initialize server: %s\n", strerror(errno));
         return EXIT_FAILURE;
     }
+    rc = sec_lsm_manager_server_set_workers(server, (unsigned)nrwork);
+    if (rc < 0) {
+        fprintf(stderr, "can't start workers: %s\n", strerror(-rc));
+        return EXIT_FAILURE;
+    }
 
     /* ready ! */
 #if WITH_SYSTEMD
@@ -24,6 +24,7 @@
 #include "cynagora-interface.h"
 
 #include <errno.h>
+#include <pthread.h>
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
@@ -53,17 +54,29 @@ const perm_mgr_itf_t cynagora_itf =
 /** cynagora client used by all client */
 cynagora_t *cynagora_handler = NULL;
 
+/** mutex serializing the use of the cynagora client by concurrent workers */
+static pthread_mutex_t cynagora_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /***********************/
 /*** PRIVATE METHODS ***/
 /***********************/
 
+/**
+ * @brief Get the common cynagora handler and lock it,
+ * it must be unlocked using put on success.
+ *
+ * @param[out] handler where to store the handler
+ * @return 0 in case of success or a negative -errno value
+ */
 static int get(cynagora_t **handler)
 {
+    pthread_mutex_lock(&cynagora_mutex);
     if (cynagora_handler == NULL) {
         int rc = cynagora_create(&cynagora_handler, cynagora_Admin, 1, 0);
         if (rc < 0) {
             ERROR("cynagora_create: %d %s", -rc, strerror(-rc));
             cynagora_handler = NULL;
+            pthread_mutex_unlock(&cynagora_mutex);
             return rc;
         }
     }
@@ -71,6 +84,14 @@ static int get(cynagora_t **handler)
     return 0;
 }
 
+/**
+ * @brief Unlock the common cynagora handler got using get
+ */
+static void put(void)
+{
+    pthread_mutex_unlock(&cynagora_mutex);
+}
+
 /**********************/
 /*** PUBLIC METHODS ***/
 /**********************/
@@ -93,6 +114,7 @@ int cynagora_set_policies(const char *label, const permission_set_t *permission_
     rc = cynagora_enter(cynagora);
     if (rc < 0) {
         ERROR("cynagora_enter : %d %s", -rc, strerror(-rc));
+        put();
         return rc;
     }
 
@@ -134,6 +156,7 @@ int cynagora_set_policies(const char *label, const permission_set_t *permission_
             rc = rc2;
     }
 
+    put();
     return rc;
 }
 
@@ -159,7 +182,9 @@ int cynagora_check_permission(const char *label, const char *permission)
     if (rc < 0)
         return rc;
 
-    return cynagora_check(cynagora, &key, 0);
+    rc = cynagora_check(cynagora, &key, 0);
+    put();
+    return rc;
 }
 
 static void list(void *closure, const cynagora_key_t *key, const cynagora_value_t *value) {
@@ -188,6 +213,7 @@ int cynagora_get_policies(const char *label, permission_set_t *permission_set) {
         return rc;
 
     rc = cynagora_get(cynagora, &k, list, permission_set);
+    put();
     if (rc < 0)
         return rc;
 
@@ -25,32 +25,84 @@
 #include "client.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
-#include <poll.h>
 
 #include "action/action.h"
 #include "context/context.h"
 #include "log.h"
+#include "manifest.h"
 #include "prot.h"
 #include "sec-lsm-manager-protocol.h"
 #include "utf8-utils.h"
+#include "worker.h"
 
 #define VERSION_BITS              3
 #define _STR_(x)                  #x
 #define PROTOCOL_STRING(x)        _STR_(x)
 #define PROTOCOL_VERSION_1        1
 #define PROTOCOL_VERSION_1_STRING PROTOCOL_STRING(PROTOCOL_VERSION_1)
+#define PROTOCOL_VERSION_2        2
+#define PROTOCOL_VERSION_2_STRING PROTOCOL_STRING(PROTOCOL_VERSION_2)
 #define DEFAULT_PROTOCOL_VERSION  PROTOCOL_VERSION_1
 
 #define MAX_PUTX_ITEMS            15
 
+#ifndef MAX_TICKET_COUNT
+#define MAX_TICKET_COUNT          32
+#endif
+
 extern bool sec_lsm_manager_server_log;
 
+typedef int (*action_t)(context_t *context);
+typedef void (*reply_t)(client_t *client, int rc);
+
+typedef struct ticket ticket_t;
+typedef struct outrec outrec_t;
+
+/** structure for records waiting for room in the output buffer */
+struct outrec
+{
+    /** next record of the queue */
+    outrec_t *next;
+
+    /** count of fields */
+    unsigned count;
+
+    /** the fields, copied after the structure */
+    const char *fields[];
+};
+
+/** structure recording an asynchronous install */
+struct ticket
+{
+    /** the job of the install */
+    worker_job_t job;
+
+    /** the client owning the ticket */
+    client_t *client;
+
+    /** the context to install, released at completion */
+    context_t *context;
+
+    /** next ticket of the client */
+    ticket_t *next;
+
+    /** identifier of the ticket */
+    unsigned id;
+
+    /** is the install completed */
+    bool completed;
+
+    /** the result of the install when completed */
+    int rc;
+};
+
 /** structure that represents a client */
 struct client
 {
@@ -66,11 +118,62 @@ struct client
     /** is the actual link invalid or valid */
     unsigned invalid: 1;
 
+    /** is an action running in a worker thread */
+    unsigned busy: 1;
+
+    /** is destruction requested while actions are running */
+    unsigned destroyed: 1;
+
+    /** is output blocked, waiting the output to be writable */
+    unsigned blocked: 1;
+
+    /** count of actions running in worker threads */
+    unsigned running;
+
     /** fdin */
     int fdin;
 
     /** fdout */
     int fdout;
+
+    /** the workers for running actions or NULL */
+    worker_pool_t *workers;
+
+    /** callback to the owner when a running action is completed */
+    void (*resume)(void *closure);
+
+    /** closure of the resume callback */
+    void *resume_closure;
+
+    /** job for running actions */
+    worker_job_t job;
+
+    /** the running action */
+    action_t action;
+
+    /** the reply of the running action */
+    reply_t reply;
+
+    /** the result of the running action */
+    int action_rc;
+
+    /** the tickets of asynchronous installs */
+    ticket_t *tickets;
+
+    /** count of tickets */
+    unsigned ticket_count;
+
+    /** identifier of the latest ticket */
+    unsigned ticket_id;
+
+    /** identifier of the ticket waited or 0 */
+    unsigned waited_id;
+
+    /** head of the queue of records waiting for room in the output buffer */
+    outrec_t *outq_head;
+
+    /** tail of the queue of records waiting for room in the output buffer */
+    outrec_t *outq_tail;
 };
 
 static int display_id(void *client, const char *id);
@@ -135,44 +238,103 @@ static bool ckarg(const char *arg, const char *value, unsigned offset)
 }
 
 /**
- * @brief Flush the write buffer
+ * @brief Add a record at the end of the output queue
  *
  * @param[in] client client handler
- * @return 0 in case of success or a negative -errno value
+ * @param[in] count count of fields
+ * @param[in] fields the fields of the record
+ * @return 0 in case of success or -ENOMEM
+ */
+__nonnull()
+static int enqueue_output(client_t *client, unsigned count, const char *fields[])
+{
+    outrec_t *rec;
+    size_t size;
+    unsigned i;
+    char *text;
+
+    /* allocate */
+    size = sizeof *rec + count * sizeof *rec->fields;
+    for (i = 0 ; i < count ; i++)
+        size += strlen(fields[i]) + 1;
+    rec = malloc(size);
+    if (rec == NULL)
+        return -ENOMEM;
+
+    /* copy */
+    text = (char*)&rec->fields[count];
+    for (i = 0 ; i < count ; i++) {
+        rec->fields[i] = text;
+        text = stpcpy(text, fields[i]) + 1;
+    }
+    rec->count = count;
+
+    /* link */
+    rec->next = NULL;
+    if (client->outq_tail == NULL)
+        client->outq_head = rec;
+    else
+        client->outq_tail->next = rec;
+    client->outq_tail = rec;
+    return 0;
+}
+
+/**
+ * @brief Remove the first record of the output queue
+ *
+ * @param[in] client client handler
+ */
+__nonnull()
+static void dequeue_output(client_t *client)
+{
+    outrec_t *rec = client->outq_head;
+
+    client->outq_head = rec->next;
+    if (client->outq_head == NULL)
+        client->outq_tail = NULL;
+    free(rec);
+}
+
+/**
+ * @brief Flush the write buffer and the output queue as much as
+ * possible without blocking. When the output would block, the client
+ * is marked blocked and its owner has to call client_flush_output
+ * when the output is writable.
+ *
+ * @param[in] client client handler
+ * @return 0 when all is written, -EAGAIN when the output would block
+ *         or a negative -errno value
  */
 __nonnull()
 static int flushw(client_t *client)
 {
     int rc;
-    struct pollfd pfd;
 
     for (;;) {
-        rc = prot_should_write(client->prot);
-        if (rc < 0)
-            ERROR("flushw: should write returned error %s", strerror(-rc));
-        else if (rc > 0) {
-            rc = prot_write(client->prot, client->fdout);
-            if (rc >= 0)
-                continue;
-            if (rc == -ENODATA)
-                rc = 0;
-            else if (rc != -EAGAIN)
+        /* fill the write buffer with the queued records */
+        while (client->outq_head != NULL) {
+            rc = prot_put(client->prot, client->outq_head->count, client->outq_head->fields);
+            if (rc == -ECANCELED && prot_should_write(client->prot))
+                break; /* no room until write */
+            if (rc < 0)
+                ERROR("flushw: dropping record: %s", strerror(-rc));
+            dequeue_output(client);
+        }
+
+        /* write the buffer */
+        if (!prot_should_write(client->prot)) {
+            client->blocked = 0;
+            return 0;
+        }
+        rc = prot_write(client->prot, client->fdout);
+        if (rc < 0) {
+            if (rc == -EAGAIN)
+                client->blocked = 1;
+            else
                 ERROR("flushw: write returned error %s", strerror(-rc));
-            else {
-                pfd.fd = client->fdout;
-                pfd.events = POLLOUT;
-                do {
-                    rc = poll(&pfd, 1, 0);
-                } while (rc < 0 && errno == EINTR);
-                if (rc >= 0)
-                    continue;
-                rc = -errno;
-                ERROR("flushw: poll returned error %s", strerror(-rc));
-            }
+            return rc;
         }
-        break;
     }
-    return rc;
 }
 
 /**
@@ -205,20 +367,29 @@ static int putx(client_t *client, ...) {
 
     dolog_protocol(client, 0, n, fields);
 
-    /* send now */
-    rc = prot_put(client->prot, n, fields);
-    if (rc == -ECANCELED) {
-        rc = flushw(client);
-        if (rc == 0) {
-            rc = prot_put(client->prot, n, fields);
+    /* version 2 transmits the opcode instead of the name */
+    if (client->version == PROTOCOL_VERSION_2 && n > 0)
+        fields[0] = sec_lsm_manager_opcode_code(sec_lsm_manager_opcode_of_name(fields[0]));
+
+    /* send now if not queueing */
+    if (client->outq_head == NULL) {
+        rc = prot_put(client->prot, n, fields);
+        if (rc == -ECANCELED) {
+            rc = flushw(client);
+            if (rc == 0 || rc == -EAGAIN)
+                rc = prot_put(client->prot, n, fields);
+        }
+        if (rc != -ECANCELED) {
             if (rc < 0)
-                goto put_error;
+                ERROR("putx: prot_put returned the error %s", strerror(-rc));
+            return rc;
         }
     }
-    else if (rc < 0) {
-put_error:
-        ERROR("putx: prot_put returned the error %s", strerror(-rc));
-    }
+
+    /* queue until the output is writable */
+    rc = enqueue_output(client, n, fields);
+    if (rc < 0)
+        ERROR("putx: can't queue output %s", strerror(-rc));
     return rc;
 }
 
@@ -233,6 +404,19 @@ static void send_done(client_t *client, const char *arg) {
     flushw(client);
 }
 
+/**
+ * @brief emit a simple error reply and flush without raising
+ * the error flag of the context
+ *
+ * @param[in] client client handler
+ * @param[in] errorstr string error to send
+ */
+__nonnull((1))
+static void send_error_status(client_t *client, const char *errorstr) {
+    putx(client, _error_, errorstr, NULL);
+    flushw(client);
+}
+
 /**
  * @brief emit a simple error reply and flush
  *
@@ -242,8 +426,7 @@ static void send_done(client_t *client, const char *arg) {
 __nonnull((1))
 static void send_error(client_t *client, const char *errorstr) {
     context_raise_error(client->context);
-    putx(client, _error_, errorstr, NULL);
-    flushw(client);
+    send_error_status(client, errorstr);
 }
 
 /* visitor's id callback for displaying context */
@@ -289,6 +472,295 @@ static int send_display(client_t *client) {
     return rc;
 }
 
+/**
+ * @brief get the protocol text of an install error
+ *
+ * @param[in] rc the negative result of the install
+ * @return the error text
+ */
+__wur
+static const char *install_error_text(int rc)
+{
+    switch (-rc) {
+    case ENOTRECOVERABLE: return "not-recoverable";
+    case EINVAL:          return "invalid";
+    case EPERM:           return "forbidden";
+    default:              return "internal";
+    }
+}
+
+/**
+ * @brief emit the reply to an install query
+ *
+ * @param[in] client client handler
+ * @param[in] rc the result of the install
+ */
+__nonnull()
+static void reply_install(client_t *client, int rc)
+{
+    const char *errtxt;
+
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        errtxt = install_error_text(rc);
+        send_error(client, errtxt);
+        ERROR("sec_lsm_manager_handle_install: %s", errtxt);
+    }
+}
+
+/**
+ * @brief emit the reply to an uninstall query
+ *
+ * @param[in] client client handler
+ * @param[in] rc the result of the uninstall
+ */
+__nonnull()
+static void reply_uninstall(client_t *client, int rc)
+{
+    const char *errtxt;
+
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        switch (-rc) {
+        case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
+        case EINVAL:       errtxt = "invalid"; break;
+        default:           errtxt = "internal"; break;
+        }
+        send_error(client, errtxt);
+        ERROR("sec_lsm_manager_handle_uninstall: %s", errtxt);
+    }
+}
+
+/**
+ * @brief free the memory of the client
+ *
+ * @param[in] client client handler
+ */
+__nonnull()
+static void release(client_t *client)
+{
+    ticket_t *ticket;
+
+    while (client->outq_head != NULL)
+        dequeue_output(client);
+    while ((ticket = client->tickets) != NULL) {
+        client->tickets = ticket->next;
+        free(ticket);
+    }
+    prot_destroy(client->prot);
+    context_destroy(client->context);
+    free(client);
+}
+
+/**
+ * @brief process the running action, called in a worker thread
+ *
+ * @param[in] job the job of the client
+ */
+__nonnull()
+static void process_action(worker_job_t *job)
+{
+    client_t *client = (client_t*)((char*)job - offsetof(client_t, job));
+
+    client->action_rc = client->action(client->context);
+}
+
+/**
+ * @brief complete the running action, called in the thread of the client
+ *
+ * @param[in] job the job of the client
+ */
+__nonnull()
+static void complete_action(worker_job_t *job)
+{
+    client_t *client = (client_t*)((char*)job - offsetof(client_t, job));
+
+    client->busy = 0;
+    if (--client->running == 0 && client->destroyed)
+        release(client);
+    else if (!client->destroyed) {
+        if (client_is_connected(client))
+            client->reply(client, client->action_rc);
+        if (client->resume != NULL)
+            client->resume(client->resume_closure);
+    }
+}
+
+/**
+ * @brief run the action and reply, in a worker thread if workers are set
+ *
+ * @param[in] client client handler
+ * @param[in] action the action to run
+ * @param[in] reply the reply to emit with the result of the action
+ */
+__nonnull()
+static void run_action(client_t *client, action_t action, reply_t reply)
+{
+    if (client->workers == NULL)
+        reply(client, action(client->context));
+    else {
+        client->busy = 1;
+        client->running++;
+        client->action = action;
+        client->reply = reply;
+        client->job.process = process_action;
+        client->job.completed = complete_action;
+        worker_pool_post(client->workers, &client->job);
+    }
+}
+
+/**
+ * @brief search the ticket of the given text identifier
+ *
+ * @param[in] client client handler
+ * @param[in] text the text of the identifier of the ticket
+ * @param[out] prev where to store the pointer referencing the ticket
+ * @return the ticket or NULL if not found
+ */
+__nonnull() __wur
+static ticket_t *search_ticket(client_t *client, const char *text, ticket_t ***prev)
+{
+    char *end;
+    unsigned long id;
+    ticket_t **it;
+
+    id = strtoul(text, &end, 10);
+    if (*text < '0' || *text > '9' || *end != '\0')
+        return NULL;
+    for (it = &client->tickets ; *it != NULL ; it = &(*it)->next)
+        if ((*it)->id == id) {
+            *prev = it;
+            return *it;
+        }
+    return NULL;
+}
+
+/**
+ * @brief emit the reply to a wait query of a completed ticket
+ * and drop the ticket
+ *
+ * @param[in] client client handler
+ * @param[in] prev the pointer referencing the ticket
+ */
+__nonnull()
+static void reply_wait(client_t *client, ticket_t **prev)
+{
+    ticket_t *ticket = *prev;
+
+    if (ticket->rc >= 0)
+        send_done(client, NULL);
+    else
+        send_error_status(client, install_error_text(ticket->rc));
+    *prev = ticket->next;
+    client->ticket_count--;
+    free(ticket);
+}
+
+/**
+ * @brief process the asynchronous install, called in a worker thread
+ *
+ * @param[in] job the job of the ticket
+ */
+__nonnull()
+static void process_ticket(worker_job_t *job)
+{
+    ticket_t *ticket = (ticket_t*)((char*)job - offsetof(ticket_t, job));
+
+    ticket->rc = action_install(ticket->context);
+}
+
+/**
+ * @brief complete the asynchronous install, called in the thread of the client
+ *
+ * @param[in] job the job of the ticket
+ */
+__nonnull()
+static void complete_ticket(worker_job_t *job)
+{
+    ticket_t *ticket = (ticket_t*)((char*)job - offsetof(ticket_t, job));
+    client_t *client = ticket->client;
+    ticket_t **prev;
+
+    ticket->completed = true;
+    context_destroy(ticket->context);
+    ticket->context = NULL;
+    if (--client->running == 0 && client->destroyed)
+        release(client);
+    else if (!client->destroyed && client->waited_id == ticket->id) {
+        /* reply to the pending wait */
+        for (prev = &client->tickets ; *prev != ticket ; prev = &(*prev)->next);
+        client->waited_id = 0;
+        client->busy = 0;
+        if (client_is_connected(client))
+            reply_wait(client, prev);
+        if (client->resume != NULL)
+            client->resume(client->resume_closure);
+    }
+}
+
+/**
+ * @brief start an asynchronous install of the current context, the client
+ * continues with a new context
+ *
+ * @param[in] client client handler
+ */
+__nonnull()
+static void install_async(client_t *client)
+{
+    char text[20];
+    ticket_t *ticket;
+    context_t *context;
+    int rc;
+
+    /* check the count of tickets */
+    if (client->ticket_count >= MAX_TICKET_COUNT) {
+        send_error_status(client, "too-many");
+        return;
+    }
+
+    /* allocate the ticket and the new context */
+    ticket = calloc(1, sizeof *ticket);
+    if (ticket == NULL) {
+        send_error_status(client, "internal");
+        return;
+    }
+    rc = context_create(&context);
+    if (rc < 0) {
+        free(ticket);
+        send_error_status(client, "internal");
+        return;
+    }
+    context_set_permission_manager(context, client->context->permgr);
+
+    /* record the ticket */
+    ticket->client = client;
+    ticket->context = client->context;
+    ticket->id = ++client->ticket_id;
+    ticket->next = client->tickets;
+    client->tickets = ticket;
+    client->ticket_count++;
+    client->context = context;
+
+    /* start the install */
+    if (client->workers == NULL) {
+        ticket->rc = action_install(ticket->context);
+        ticket->completed = true;
+        context_destroy(ticket->context);
+        ticket->context = NULL;
+    }
+    else {
+        client->running++;
+        ticket->job.process = process_ticket;
+        ticket->job.completed = complete_ticket;
+        worker_pool_post(client->workers, &ticket->job);
+    }
+
+    snprintf(text, sizeof text, "%u", ticket->id);
+    send_done(client, text);
+}
+
 /**
  * @brief checks utf8 validity of received fields
  *
@@ -305,6 +777,379 @@ static bool check_utf8(unsigned count, const char *args[])
     return true;
 }
 
+/**
+ * @brief handle the request clear
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_clear(client_t *client, unsigned count, const char *args[])
+{
+    (void)args;
+    if (count != 1)
+        return false;
+    context_clear(client->context);
+    send_done(client, NULL);
+    return true;
+}
+
+/**
+ * @brief handle the request display
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_display(client_t *client, unsigned count, const char *args[])
+{
+    int rc;
+
+    (void)args;
+    if (count != 1)
+        return false;
+    rc = send_display(client);
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        send_error(client, "internal");
+        ERROR("send_display_context: %d %s", -rc, strerror(-rc));
+    }
+    return true;
+}
+
+/**
+ * @brief handle the request id
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_id(client_t *client, unsigned count, const char *args[])
+{
+    int rc;
+    const char *errtxt;
+
+    if (count != 2)
+        return false;
+    rc = context_set_id(client->context, args[1]);
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        switch (-rc) {
+        case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
+        case EINVAL:       errtxt = "invalid"; break;
+        case EEXIST:       errtxt = "already-set"; break;
+        default:           errtxt = "internal"; break;
+        }
+        send_error(client, errtxt);
+        ERROR("sec_lsm_manager_handle_set_id: %s", errtxt);
+    }
+    return true;
+}
+
+/**
+ * @brief handle the request install
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_install(client_t *client, unsigned count, const char *args[])
+{
+    if (count == 1)
+        run_action(client, action_install, reply_install);
+    else if (count == 2 && ckarg(args[1], _async_, 0))
+        install_async(client);
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief handle the request log
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_log(client_t *client, unsigned count, const char *args[])
+{
+    int nextlog;
+
+    if (count > 2)
+        return false;
+    nextlog = sec_lsm_manager_server_log;
+    if (count == 2) {
+        if (!ckarg(args[1], _on_, 0) && !ckarg(args[1], _off_, 0))
+            return false;
+        nextlog = ckarg(args[1], _on_, 0);
+    }
+    send_done(client, nextlog ? _on_ : _off_);
+    sec_lsm_manager_server_log = nextlog;
+    return true;
+}
+
+/**
+ * @brief handle the request manifest: the context is replaced by the one
+ * described by the manifest file passed with the request
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_manifest(client_t *client, unsigned count, const char *args[])
+{
+    int rc, fd;
+    context_t *context;
+    const char *errtxt;
+
+    (void)args;
+    if (count != 1)
+        return false;
+    fd = prot_get_fd(client->prot);
+    if (fd < 0) {
+        ERROR("no file passed with manifest");
+        rc = -EBADF;
+    }
+    else {
+        rc = context_create(&context);
+        if (rc >= 0) {
+            context_set_permission_manager(context, client->context->permgr);
+            rc = manifest_load_fd(context, fd);
+            if (rc < 0)
+                context_destroy(context);
+            else {
+                context_destroy(client->context);
+                client->context = context;
+            }
+        }
+        close(fd);
+    }
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        switch (-rc) {
+        case EBADF:        errtxt = "invalid"; break;
+        case EBADMSG:      errtxt = "invalid"; break;
+        case EFBIG:        errtxt = "invalid"; break;
+        case EINVAL:       errtxt = "invalid"; break;
+        case EEXIST:       errtxt = "already-set"; break;
+        case ENOENT:       errtxt = "not-found"; break;
+        case EACCES:       errtxt = "no-access"; break;
+        case ENOTDIR:      errtxt = "not-dir"; break;
+        default:           errtxt = "internal"; break;
+        }
+        send_error(client, errtxt);
+        ERROR("error when loading manifest: %s", errtxt);
+    }
+    return true;
+}
+
+/**
+ * @brief handle the request path
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_path(client_t *client, unsigned count, const char *args[])
+{
+    int rc;
+    const char *errtxt;
+
+    if (count != 3)
+        return false;
+    rc = context_add_path(client->context, args[1], args[2]);
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        switch (-rc) {
+        case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
+        case EINVAL:       errtxt = "invalid"; break;
+        case EEXIST:       errtxt = "already-set"; break;
+        case ENOENT:       errtxt = "not-found"; break;
+        case EACCES:       errtxt = "no-access"; break;
+        default:           errtxt = "internal"; break;
+        }
+        send_error(client, errtxt);
+        ERROR("error when adding path: %s", errtxt);
+    }
+    return true;
+}
+
+/**
+ * @brief handle the request permission
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_permission(client_t *client, unsigned count, const char *args[])
+{
+    int rc;
+    const char *errtxt;
+
+    if (count != 2)
+        return false;
+    rc = context_add_permission(client->context, args[1]);
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        switch (-rc) {
+        case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
+        case EINVAL:       errtxt = "invalid"; break;
+        case EEXIST:       errtxt = "already-set"; break;
+        default:           errtxt = "internal"; break;
+        }
+        send_error(client, errtxt);
+        ERROR("error when adding permission: %s", errtxt);
+    }
+    return true;
+}
+
+/**
+ * @brief handle the request plug
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_plug(client_t *client, unsigned count, const char *args[])
+{
+    int rc;
+    const char *errtxt;
+
+    if (count != 4)
+        return false;
+    rc = context_add_plug(client->context, args[1], args[2], args[3]);
+    if (rc >= 0) {
+        send_done(client, NULL);
+    } else {
+        switch (-rc) {
+        case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
+        case EINVAL:       errtxt = "invalid"; break;
+        case EEXIST:       errtxt = "already-set"; break;
+        case ENOENT:       errtxt = "not-found"; break;
+        case EACCES:       errtxt = "no-access"; break;
+        case ENOTDIR:      errtxt = "not-dir"; break;
+        default:           errtxt = "internal"; break;
+        }
+        send_error(client, errtxt);
+        ERROR("error when adding plug: %s", errtxt);
+    }
+    return true;
+}
+
+/**
+ * @brief handle the request status
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_status(client_t *client, unsigned count, const char *args[])
+{
+    ticket_t *ticket, **prev;
+
+    if (count != 2)
+        return false;
+    ticket = search_ticket(client, args[1], &prev);
+    if (ticket == NULL)
+        send_error_status(client, "not-found");
+    else if (!ticket->completed)
+        send_done(client, _pending_);
+    else if (ticket->rc >= 0)
+        send_done(client, _installed_);
+    else {
+        putx(client, _done_, _failed_, install_error_text(ticket->rc), NULL);
+        flushw(client);
+    }
+    return true;
+}
+
+/**
+ * @brief handle the request uninstall
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_uninstall(client_t *client, unsigned count, const char *args[])
+{
+    (void)args;
+    if (count != 1)
+        return false;
+    run_action(client, action_uninstall, reply_uninstall);
+    return true;
+}
+
+/**
+ * @brief handle the request wait
+ *
+ * @param[in] client client handler
+ * @param[in] count The number or arguments
+ * @param[in] args Arguments
+ * @return false if the request is invalid
+ */
+__nonnull((1)) __wur
+static bool on_wait(client_t *client, unsigned count, const char *args[])
+{
+    ticket_t *ticket, **prev;
+
+    if (count != 2)
+        return false;
+    ticket = search_ticket(client, args[1], &prev);
+    if (ticket == NULL)
+        send_error_status(client, "not-found");
+    else if (ticket->completed)
+        reply_wait(client, prev);
+    else {
+        /* suspend the client until completion */
+        client->waited_id = ticket->id;
+        client->busy = 1;
+    }
+    return true;
+}
+
+/** handlers of the requests indexed by opcode */
+static bool (*const handlers[opcode_count])(client_t *client, unsigned count, const char *args[]) = {
+    [opcode_clear]      = on_clear,
+    [opcode_display]    = on_display,
+    [opcode_id]         = on_id,
+    [opcode_install]    = on_install,
+    [opcode_log]        = on_log,
+    [opcode_manifest]   = on_manifest,
+    [opcode_path]       = on_path,
+    [opcode_permission] = on_permission,
+    [opcode_plug]       = on_plug,
+    [opcode_status]     = on_status,
+    [opcode_uninstall]  = on_uninstall,
+    [opcode_wait]       = on_wait
+};
+
 /**
  * @brief handle a request
  *
@@ -313,15 +1158,26 @@ static bool check_utf8(unsigned count, const char *args[])
  * @param[in] args Arguments
  */
 __nonnull((1)) static void onrequest(client_t *client, unsigned count, const char *args[]) {
-    int nextlog, rc;
-    const char *errtxt;
+    unsigned opcode;
+    const char *code;
 
     /* just ignore empty lines */
     if (count == 0)
         return;
 
-    /* emit the log */
-    dolog_protocol(client, 1, count, args);
+    /* emit the log, with version 2 the name of the opcode is logged */
+    if (client->version == PROTOCOL_VERSION_2) {
+        opcode = sec_lsm_manager_opcode_of_code(args[0]);
+        code = args[0];
+        if (opcode != opcode_none)
+            args[0] = sec_lsm_manager_opcode_name(opcode);
+        dolog_protocol(client, 1, count, args);
+        args[0] = code;
+    }
+    else {
+        opcode = opcode_none;
+        dolog_protocol(client, 1, count, args);
+    }
 
     /* check utf8 validity */
     if (!check_utf8(count, args))
@@ -336,166 +1192,25 @@ __nonnull((1)) static void onrequest(client_t *client, unsigned count, const cha
                     goto invalid_protocol;
                 if (ckarg(args[idx], PROTOCOL_VERSION_1_STRING, 0))
                     version = PROTOCOL_VERSION_1;
+                else if (ckarg(args[idx], PROTOCOL_VERSION_2_STRING, 0))
+                    version = PROTOCOL_VERSION_2;
             }
-            client->version = version & ((1 << VERSION_BITS) - 1);
             send_done(client, args[idx]);
+            /* records following the reply are binary in version 2 */
+            client->version = version & ((1 << VERSION_BITS) - 1);
+            prot_set_binary(client->prot, version == PROTOCOL_VERSION_2);
             return;
         }
         /* switch automatically to default version */
         client->version = DEFAULT_PROTOCOL_VERSION;
     }
 
-    switch (args[0][0]) {
-        case 'c':
-            /* clear */
-            if (ckarg(args[0], _clear_, 1) && count == 1) {
-                context_clear(client->context);
-                send_done(client, NULL);
-                return;
-            }
-            break;
-        case 'd':
-            /* display */
-            if (ckarg(args[0], _display_, 1) && count == 1) {
-                rc = send_display(client);
-                if (rc >= 0) {
-                    send_done(client, NULL);
-                } else {
-                    send_error(client, "internal");
-                    ERROR("send_display_context: %d %s", -rc, strerror(-rc));
-                }
-                return;
-            }
-            break;
-        case 'i':
-            /* id */
-            if (ckarg(args[0], _id_, 1) && count == 2) {
-                rc = context_set_id(client->context, args[1]);
-                if (rc >= 0) {
-                    send_done(client, NULL);
-                } else {
-                    switch (-rc) {
-                    case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
-                    case EINVAL:       errtxt = "invalid"; break;
-                    case EEXIST:       errtxt = "already-set"; break;
-                    default:           errtxt = "internal"; break;
-                    }
-                    send_error(client, errtxt);
-                    ERROR("sec_lsm_manager_handle_set_id: %s", errtxt);
-                }
-                return;
-            }
-            /* install */
-            if (ckarg(args[0], _install_, 1) && count == 1) {
-                rc = action_install(client->context);
-                if (rc >= 0) {
-                    send_done(client, NULL);
-                } else {
-                    switch (-rc) {
-                    case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
-                    case EINVAL:       errtxt = "invalid"; break;
-                    case EPERM:        errtxt = "forbidden"; break;
-                    default:           errtxt = "internal"; break;
-                    }
-                    send_error(client, errtxt);
-                    ERROR("sec_lsm_manager_handle_install: %s", errtxt);
-                }
-                return;
-            }
-            break;
-        case 'l':
-            /* log */
-            if (ckarg(args[0], _log_, 1) && count <= 2) {
-                nextlog = sec_lsm_manager_server_log;
-                if (count == 2) {
-                    if (!ckarg(args[1], _on_, 0) && !ckarg(args[1], _off_, 0))
-                        goto invalid_protocol;
-                    nextlog = ckarg(args[1], _on_, 0);
-                }
-                send_done(client, nextlog ? _on_ : _off_);
-                sec_lsm_manager_server_log = nextlog;
-                return;
-            }
-            break;
-        case 'p':
-            /* path */
-            if (ckarg(args[0], _path_, 1) && count == 3) {
-                rc = context_add_path(client->context, args[1], args[2]);
-                if (rc >= 0) {
-                    send_done(client, NULL);
-                } else {
-                    switch (-rc) {
-                    case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
-                    case EINVAL:       errtxt = "invalid"; break;
-                    case EEXIST:       errtxt = "already-set"; break;
-                    case ENOENT:       errtxt = "not-found"; break;
-                    case EACCES:       errtxt = "no-access"; break;
-                    default:           errtxt = "internal"; break;
-                    }
-                    send_error(client, errtxt);
-                    ERROR("error when adding path: %s", errtxt);
-                }
-                return;
-            }
-            /* permission */
-            if (ckarg(args[0], _permission_, 1) && count == 2) {
-                rc = context_add_permission(client->context, args[1]);
-                if (rc >= 0) {
-                    send_done(client, NULL);
-                } else {
-                    switch (-rc) {
-                    case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
-                    case EINVAL:       errtxt = "invalid"; break;
-                    case EEXIST:       errtxt = "already-set"; break;
-                    default:           errtxt = "internal"; break;
-                    }
-                    send_error(client, errtxt);
-                    ERROR("error when adding permission: %s", errtxt);
-                }
-                return;
-            }
-            /* plug */
-            if (ckarg(args[0], _plug_, 1) && count == 4) {
-                rc = context_add_plug(client->context, args[1], args[2], args[3]);
-                if (rc >= 0) {
-                    send_done(client, NULL);
-                } else {
-                    switch (-rc) {
-                    case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
-                    case EINVAL:       errtxt = "invalid"; break;
-                    case EEXIST:       errtxt = "already-set"; break;
-                    case ENOENT:       errtxt = "not-found"; break;
-                    case EACCES:       errtxt = "no-access"; break;
-                    case ENOTDIR:      errtxt = "not-dir"; break;
-                    default:           errtxt = "internal"; break;
-                    }
-                    send_error(client, errtxt);
-                    ERROR("error when adding plug: %s", errtxt);
-                }
-                return;
-            }
-            break;
-        case 'u':
-            /* uninstall */
-            if (ckarg(args[0], _uninstall_, 1) && count == 1) {
-                rc = action_uninstall(client->context);
-                if (rc >= 0) {
-                    send_done(client, NULL);
-                } else {
-                    switch (-rc) {
-                    case ENOTRECOVERABLE: errtxt = "not-recoverable"; break;
-                    case EINVAL:       errtxt = "invalid"; break;
-                    default:           errtxt = "internal"; break;
-                    }
-                    send_error(client, errtxt);
-                    ERROR("sec_lsm_manager_handle_uninstall: %s", errtxt);
-                }
-                return;
-            }
-            break;
-        default:
-            break;
-    }
+    /* dispatch, version 2 only accepts the codes of the opcodes */
+    if (client->version != PROTOCOL_VERSION_2)
+        opcode = sec_lsm_manager_opcode_of_name(args[0]);
+    if (handlers[opcode] != NULL && handlers[opcode](client, count, args))
+        return;
+
 invalid_protocol:
     send_error(client, "protocol");
     client->invalid = 1;
@@ -592,9 +1307,10 @@ __nonnull()
 void client_destroy(client_t *client)
 {
     client_disconnect(client);
-    prot_destroy(client->prot);
-    context_destroy(client->context);
-    free(client);
+    if (client->running > 0)
+        client->destroyed = 1; /* released at completion */
+    else
+        release(client);
 }
 
 /* see client.h */
@@ -605,14 +1321,21 @@ int client_process_input(client_t *client)
     const char **args;
 
     for (;;) {
+        /* try to unblock the output */
+        if (client->blocked) {
+            rc = flushw(client);
+            if (rc < 0 && rc != -EAGAIN)
+                return rc;
+        }
+
         /* process the pending available requests */
-        while (!client->invalid) {
+        while (!client->invalid && !client->busy && !client->blocked) {
             rc = prot_get(client->prot, &args);
             if (rc > 0)
                 onrequest(client, (unsigned)rc, args);
             else if (rc < 0) {
-                if (rc == -EMSGSIZE)
-                    return rc; /* message is toooo big */
+                if (rc != -EAGAIN)
+                    return rc; /* message is toooo big or malformed */
                 break;
             }
             prot_next(client->prot);
@@ -626,6 +1349,10 @@ int client_process_input(client_t *client)
         if (client->invalid)
             return -EPROTO;
 
+        /* wait completion of the running action or writable output */
+        if (client->busy || client->blocked)
+            return -EAGAIN;
+
         /* read the incoming data */
         rc = prot_read(client->prot, client->fdin);
         if (rc <= 0)
@@ -640,3 +1367,32 @@ const perm_mgr_itf_t *client_set_permission_manager(client_t *client, const perm
     return context_set_permission_manager(client->context, permgr);
 }
 
+/* see client.h */
+__nonnull((1))
+void client_set_workers(client_t *client, worker_pool_t *workers, void (*resume)(void *closure), void *closure)
+{
+    client->workers = workers;
+    client->resume = resume;
+    client->resume_closure = closure;
+}
+
+/* see client.h */
+__wur __nonnull()
+bool client_is_busy(client_t *client)
+{
+    return client->busy;
+}
+
+/* see client.h */
+__wur __nonnull()
+bool client_is_blocked(client_t *client)
+{
+    return client->blocked;
+}
+
+/* see client.h */
+__nonnull()
+int client_flush_output(client_t *client)
+{
+    return flushw(client);
+}
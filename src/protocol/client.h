@@ -29,6 +29,7 @@
 #include <time.h>
 
 #include "context/perm-mgr.h"
+#include "worker.h"
 
 /** abstract client type */
 typedef struct client client_t;
@@ -63,7 +64,8 @@ __nonnull()
 extern void client_disconnect(client_t *client);
 
 /**
- * @brief Destroy the client instance, disconnecting it if connected
+ * @brief Destroy the client instance, disconnecting it if connected.
+ * When an action is running, the memory is released at its completion.
  *
  * @param[in] client pointer to the client instance
  */
@@ -72,6 +74,10 @@ extern void client_destroy(client_t *client);
 
 /**
  * @brief Process the available input if any.
+ * The input is read and processed until exhaustion
+ * (-EAGAIN), making it usable with edge triggered polling.
+ * While the client is busy or blocked, the processing is suspended
+ * and -EAGAIN is returned.
  * A negative error code different from -EAGAIN
  * should imply a disconnection.
  *
@@ -98,5 +104,51 @@ extern int client_process_input(client_t *client);
 __nonnull((1))
 extern const perm_mgr_itf_t *client_set_permission_manager(client_t *client, const perm_mgr_itf_t *permgr);
 
+/**
+ * @brief Set the workers running the actions install and uninstall.
+ * When workers are set, the client becomes busy during the actions
+ * and the callback resume is called after the action is completed
+ * and its reply is sent. The callback should then process again
+ * the input of the client. When workers is NULL, the actions are
+ * processed synchronously.
+ *
+ * @param[in] client pointer to the client instance
+ * @param[in] workers the pool of workers or NULL
+ * @param[in] resume callback called when an action is completed (might be NULL)
+ * @param[in] closure closure of the callback
+ */
+__nonnull((1))
+extern void client_set_workers(client_t *client, worker_pool_t *workers, void (*resume)(void *closure), void *closure);
+
+/**
+ * @brief Check if the client is busy, running an action
+ *
+ * @param[in] client pointer to the client instance
+ * @return true when busy, false otherwise
+ */
+__wur __nonnull()
+extern bool client_is_busy(client_t *client);
+
+/**
+ * @brief Check if the output of the client is blocked, waiting to
+ * be writable. Then client_flush_output should be called when the
+ * output is writable.
+ *
+ * @param[in] client pointer to the client instance
+ * @return true when blocked, false otherwise
+ */
+__wur __nonnull()
+extern bool client_is_blocked(client_t *client);
+
+/**
+ * @brief Write the pending output of the client without blocking
+ *
+ * @param[in] client pointer to the client instance
+ * @return 0 when all is written, -EAGAIN when the output is still blocked
+ *         or a negative -errno value
+ */
+__nonnull()
+extern int client_flush_output(client_t *client);
+
 #endif /* PROTOCOL_CLIENT_H */
 
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "manifest.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "log.h"
+#include "sec-lsm-manager-protocol.h"
+#include "utf8-utils.h"
+
+#ifndef MANIFEST_MAX_SIZE
+#define MANIFEST_MAX_SIZE 4194304
+#endif
+
+/** maximum count of arguments of entries */
+#define MANIFEST_MAX_ARGS 3
+
+/** seals required for mapping the manifest */
+#define MANIFEST_SEALS (F_SEAL_SHRINK | F_SEAL_WRITE)
+
+/***********************/
+/*** PRIVATE METHODS ***/
+/***********************/
+
+/**
+ * @brief Get the field of data at *pos and move *pos after it
+ *
+ * @param[in] data the manifest, its last byte is zero
+ * @param[in] size the size of the manifest
+ * @param[inout] pos position of the field
+ * @return the field or NULL if no more field or not UTF-8
+ */
+__nonnull() __wur
+static const char *next_field(const char *data, size_t size, size_t *pos)
+{
+    const char *field;
+
+    if (*pos >= size)
+        return NULL;
+    field = &data[*pos];
+    *pos += strlen(field) + 1;
+    return is_utf8(field) ? field : NULL;
+}
+
+/**
+ * @brief Get the count of arguments of entries of opcode
+ *
+ * @param[in] opcode the opcode of the entry
+ * @return the count of arguments or 0 when the opcode is invalid
+ */
+static unsigned entry_arg_count(unsigned opcode)
+{
+    switch (opcode) {
+    case opcode_id:         return 1;
+    case opcode_path:       return 2;
+    case opcode_permission: return 1;
+    case opcode_plug:       return 3;
+    default:                return 0;
+    }
+}
+
+/**********************/
+/*** PUBLIC METHODS ***/
+/**********************/
+
+/* see manifest.h */
+__nonnull() __wur
+int manifest_load(context_t *context, const char *data, size_t size)
+{
+    const char *field, *args[MANIFEST_MAX_ARGS];
+    unsigned opcode, nargs, iarg, index;
+    size_t pos = 0;
+    int rc;
+
+    /* all fields are terminated */
+    if (size == 0 || data[size - 1] != '\0') {
+        ERROR("manifest isn't terminated");
+        return -EBADMSG;
+    }
+
+    /* check the header */
+    field = next_field(data, size, &pos);
+    if (field == NULL || strcmp(field, _sec_lsm_manager_manifest_)) {
+        ERROR("manifest has no header");
+        return -EBADMSG;
+    }
+    field = next_field(data, size, &pos);
+    if (field == NULL || strcmp(field, SEC_LSM_MANAGER_MANIFEST_VERSION)) {
+        ERROR("manifest version isn't supported");
+        return -EBADMSG;
+    }
+
+    /* add the entries */
+    for (index = 0 ; pos < size ; index++) {
+        field = next_field(data, size, &pos);
+        opcode = field == NULL ? opcode_none : sec_lsm_manager_opcode_of_code(field);
+        nargs = entry_arg_count(opcode);
+        for (iarg = 0 ; iarg < nargs ; iarg++) {
+            args[iarg] = next_field(data, size, &pos);
+            if (args[iarg] == NULL)
+                break;
+        }
+        if (nargs == 0 || iarg < nargs) {
+            ERROR("manifest entry %u is malformed", index);
+            return -EBADMSG;
+        }
+
+        switch (opcode) {
+        case opcode_id:
+            rc = context_set_id(context, args[0]);
+            break;
+        case opcode_path:
+            rc = context_add_path(context, args[0], args[1]);
+            break;
+        case opcode_permission:
+            rc = context_add_permission(context, args[0]);
+            break;
+        default:
+            rc = context_add_plug(context, args[0], args[1], args[2]);
+            break;
+        }
+        if (rc < 0) {
+            ERROR("manifest entry %u failed: %d %s", index, -rc, strerror(-rc));
+            return rc;
+        }
+    }
+    return 0;
+}
+
+/* see manifest.h */
+__nonnull() __wur
+int manifest_load_fd(context_t *context, int fd)
+{
+    struct stat st;
+    size_t size;
+    void *map;
+    int rc, seals;
+
+    /* get the size of the file */
+    if (fstat(fd, &st) < 0) {
+        rc = -errno;
+        ERROR("can't stat manifest: %d %s", -rc, strerror(-rc));
+        return rc;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        ERROR("manifest isn't a regular file");
+        return -EBADF;
+    }
+    if (st.st_size > MANIFEST_MAX_SIZE) {
+        ERROR("manifest is too big: %lld bytes", (long long)st.st_size);
+        return -EFBIG;
+    }
+    size = (size_t)st.st_size;
+
+    /*
+     * only memory files whose content can't change are accepted:
+     * reading other files could block the daemon, on a network
+     * file system for example
+     */
+    seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (seals & MANIFEST_SEALS) != MANIFEST_SEALS) {
+        ERROR("manifest isn't a sealed memory file");
+        return -EBADF;
+    }
+    if (size == 0)
+        return manifest_load(context, "", 0);
+
+    /* map it */
+    map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        rc = -errno;
+        ERROR("can't map manifest: %d %s", -rc, strerror(-rc));
+        return rc;
+    }
+    rc = manifest_load(context, map, size);
+    munmap(map, size);
+    return rc;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_MANIFEST_H
+#define SEC_LSM_MANAGER_MANIFEST_H
+
+#include "context/context.h"
+
+/**
+ * A manifest describes a whole context in one file. It is made of
+ * zero terminated fields: first the header "sec-lsm-manager-manifest"
+ * and "1", then entries made of an opcode of the version 2 of the
+ * protocol followed by the arguments of the same request:
+ *
+ *   - opcode_id ID
+ *   - opcode_path PATH PATH-TYPE
+ *   - opcode_permission PERMISSION
+ *   - opcode_plug EXPDIR IMPID IMPDIR
+ */
+
+/**
+ * @brief Add the entries of the manifest of 'size' bytes at 'data'
+ * to the context. The entries are checked as the requests are:
+ * fields must be valid UTF-8 and the context applies its checks.
+ *
+ * @param[in] context the context to fill
+ * @param[in] data the manifest
+ * @param[in] size the size in bytes of the manifest
+ * @return 0 in case of success or a negative -errno value:
+ *         -EBADMSG when the manifest is malformed or the error
+ *         of the context for the failing entry
+ */
+__nonnull() __wur
+extern int manifest_load(context_t *context, const char *data, size_t size);
+
+/**
+ * @brief Add the entries of the manifest read from the file 'fd'
+ * to the context. Only memory files sealed against writing and
+ * shrinking are accepted, they are mapped: other files are never
+ * read because reading them could block.
+ *
+ * @param[in] context the context to fill
+ * @param[in] fd the file of the manifest
+ * @return 0 in case of success or a negative -errno value:
+ *         -EBADF when fd isn't a sealed memory file,
+ *         -EFBIG when the file is bigger than MANIFEST_MAX_SIZE
+ *         or the errors of manifest_load
+ */
+__nonnull() __wur
+extern int manifest_load_fd(context_t *context, int fd);
+
+#endif
@@ -29,6 +29,10 @@
 
 #include <sys/epoll.h>
 
+#ifndef POLLITEM_MAX_EVENTS
+#define POLLITEM_MAX_EVENTS 16
+#endif
+
 /**
  * @brief Wraps the call to epoll_ctl for operation 'op'
  *
@@ -60,14 +64,14 @@ int pollitem_del(pollitem_t *pollitem, int pollfd) {
 
 /* see pollitem.h */
 int pollitem_wait_dispatch(int pollfd, int timeout) {
-    int rc;
-    struct epoll_event ev;
+    int rc, idx;
+    struct epoll_event evs[POLLITEM_MAX_EVENTS];
     pollitem_t *pi;
 
-    rc = epoll_wait(pollfd, &ev, 1, timeout);
-    if (rc == 1) {
-        pi = ev.data.ptr;
-        pi->handler(pi, ev.events, pollfd);
+    rc = epoll_wait(pollfd, evs, POLLITEM_MAX_EVENTS, timeout);
+    for (idx = 0 ; idx < rc ; idx++) {
+        pi = evs[idx].data.ptr;
+        pi->handler(pi, evs[idx].events, pollfd);
     }
     return rc;
 }
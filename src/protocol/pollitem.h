@@ -78,12 +78,17 @@ extern int pollitem_mod(pollitem_t *pollitem, uint32_t events, int pollfd);
 extern int pollitem_del(pollitem_t *pollitem, int pollfd);
 
 /**
- * @brief Wait one event on epoll and dispatch it to its pollitem callback
+ * @brief Wait events on epoll and dispatch each of them to its pollitem callback
+ *
+ * Up to POLLITEM_MAX_EVENTS events are collected by one wait. The callbacks
+ * are called in the order of the events and must not release the memory
+ * of pollitems that are not theirs, because these pollitems might have
+ * an event pending in the same batch.
  *
  * @param pollfd file descriptor of the epoll
  * @param timeout time to wait
  * @return 0 on timeout
- *         1 if a callback was called
+ *         the count of callbacks called
  *         -1 with errno set accordingly to epoll_wait
  */
 extern int pollitem_wait_dispatch(int pollfd, int timeout);
@@ -30,18 +30,34 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/uio.h>
 #include <unistd.h>
 #include <limits.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #ifndef PROT_MAX_FIELDS
 #define PROT_MAX_FIELDS 20
 #endif
+#ifndef PROT_MIN_BUFFER_LENGTH
+#define PROT_MIN_BUFFER_LENGTH 2000
+#endif
 #ifndef PROT_MAX_BUFFER_LENGTH
-#define PROT_MAX_BUFFER_LENGTH 2000
+#define PROT_MAX_BUFFER_LENGTH 65536
+#endif
+#ifndef PROT_MAX_FDS
+#define PROT_MAX_FDS 4
 #endif
 #ifndef PROT_FIELD_SEPARATOR
 #define PROT_FIELD_SEPARATOR ' '
@@ -53,6 +69,13 @@
 #define PROT_ESCAPE '\\'
 #endif
 
+/** size of the header of binary records: length of the record (big endian) */
+#define PROT_BINARY_RECORD_HEADER 4
+/** size of the header of binary fields: length of the field (big endian) */
+#define PROT_BINARY_FIELD_HEADER  2
+/** maximum length of binary fields */
+#define PROT_BINARY_FIELD_MAX     0xffff
+
 /**
  * the structure buf is generic the meaning of pos/count is not fixed
  */
@@ -63,8 +86,14 @@ struct buf {
     /** a count */
     unsigned count;
 
-    /** a fixed size content */
-    char content[PROT_MAX_BUFFER_LENGTH];
+    /** allocated size of the content */
+    unsigned size;
+
+    /** maximum size of the content */
+    unsigned limit;
+
+    /** the content, growing from PROT_MIN_BUFFER_LENGTH to limit */
+    char *content;
 };
 typedef struct buf buf_t;
 
@@ -78,6 +107,19 @@ struct fields {
 };
 typedef struct fields fields_t;
 
+/** structure for queuing file descriptors passed along the data */
+struct fdq {
+    /** count of queued file descriptors */
+    unsigned count;
+
+    /** the file descriptors, the first is the oldest */
+    int fds[PROT_MAX_FDS];
+
+    /** for received ones, offset in the input buffer of the end of the data received with them */
+    unsigned ends[PROT_MAX_FDS];
+};
+typedef struct fdq fdq_t;
+
 /**
  * structure for handling the protocol
  */
@@ -109,10 +151,172 @@ struct prot {
     /** allow empty records */
     int allow_empty;
 
+    /** binary framing of records */
+    int binary;
+
+    /** input isn't a socket, file descriptors can't be received */
+    int notsock;
+
+    /** file descriptors received and not yet got */
+    fdq_t infds;
+
+    /** file descriptors to be sent with the next write */
+    fdq_t outfds;
+
     /** the fields */
     fields_t fields;
 };
 
+/**
+ * Check if the char 'c' is special: field separator,
+ * record separator or escape
+ */
+static inline int is_special(char c) {
+    return c == PROT_FIELD_SEPARATOR || c == PROT_RECORD_SEPARATOR || c == PROT_ESCAPE;
+}
+
+/**
+ * Get the length of the leading run of the 'length' bytes of 'text'
+ * that doesn't contain any special character. The run is searched
+ * by blocks using vector instructions when available.
+ */
+static size_t span_plain(const char *text, size_t length) {
+    size_t idx = 0;
+
+#if defined(__AVX2__)
+    const __m256i fs = _mm256_set1_epi8(PROT_FIELD_SEPARATOR);
+    const __m256i rs = _mm256_set1_epi8(PROT_RECORD_SEPARATOR);
+    const __m256i esc = _mm256_set1_epi8(PROT_ESCAPE);
+    __m256i v;
+    unsigned mask;
+
+    while (length - idx >= sizeof v) {
+        v = _mm256_loadu_si256((const __m256i*)&text[idx]);
+        mask = (unsigned)_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, fs),
+                                                    _mm256_cmpeq_epi8(v, rs)),
+                                    _mm256_cmpeq_epi8(v, esc)));
+        if (mask)
+            return idx + (size_t)__builtin_ctz(mask);
+        idx += sizeof v;
+    }
+#elif defined(__SSE2__)
+    const __m128i fs = _mm_set1_epi8(PROT_FIELD_SEPARATOR);
+    const __m128i rs = _mm_set1_epi8(PROT_RECORD_SEPARATOR);
+    const __m128i esc = _mm_set1_epi8(PROT_ESCAPE);
+    __m128i v;
+    unsigned mask;
+
+    while (length - idx >= sizeof v) {
+        v = _mm_loadu_si128((const __m128i*)&text[idx]);
+        mask = (unsigned)_mm_movemask_epi8(
+                    _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, fs),
+                                              _mm_cmpeq_epi8(v, rs)),
+                                 _mm_cmpeq_epi8(v, esc)));
+        if (mask)
+            return idx + (size_t)__builtin_ctz(mask);
+        idx += sizeof v;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t fs = vdupq_n_u8(PROT_FIELD_SEPARATOR);
+    const uint8x16_t rs = vdupq_n_u8(PROT_RECORD_SEPARATOR);
+    const uint8x16_t esc = vdupq_n_u8(PROT_ESCAPE);
+    uint8x16_t v;
+
+    while (length - idx >= sizeof v) {
+        v = vld1q_u8((const uint8_t*)&text[idx]);
+        if (vmaxvq_u8(vorrq_u8(vorrq_u8(vceqq_u8(v, fs), vceqq_u8(v, rs)), vceqq_u8(v, esc))))
+            break; /* found in the block, ends with the scalar loop */
+        idx += sizeof v;
+    }
+#endif
+
+    /* scalar search */
+    while (idx < length && !is_special(text[idx]))
+        idx++;
+    return idx;
+}
+
+/**
+ * Initialize the 'buf' with its minimal content
+ * returns:
+ *  - 0 on success
+ *  - -ENOMEM if allocation failed
+ */
+static int buf_init(buf_t *buf) {
+    buf->content = malloc(PROT_MIN_BUFFER_LENGTH);
+    if (buf->content == NULL)
+        return -ENOMEM;
+    buf->size = PROT_MIN_BUFFER_LENGTH;
+    buf->limit = PROT_MAX_BUFFER_LENGTH;
+    buf->pos = buf->count = 0;
+    return 0;
+}
+
+/**
+ * Get the size to use for growing 'buf'
+ * returns the new size or 0 if the limit is reached
+ */
+static unsigned buf_grow_size(buf_t *buf) {
+    unsigned size = buf->size;
+
+    if (size >= buf->limit)
+        return 0;
+    return size > buf->limit - size ? buf->limit : size << 1;
+}
+
+/**
+ * Grow the input 'buf', its content is kept in place
+ * returns:
+ *  - 0 on success
+ *  - -ENOBUFS if the limit is reached
+ *  - -ENOMEM if allocation failed
+ */
+static int inbuf_grow(buf_t *buf) {
+    char *content;
+    unsigned size = buf_grow_size(buf);
+
+    if (size == 0)
+        return -ENOBUFS;
+    content = realloc(buf->content, size);
+    if (content == NULL)
+        return -ENOMEM;
+    buf->content = content;
+    buf->size = size;
+    return 0;
+}
+
+/**
+ * Grow the output ring 'buf', its content is moved at start
+ * returns:
+ *  - 0 on success
+ *  - -ECANCELED if the limit is reached or if allocation failed
+ */
+static int outbuf_grow(buf_t *buf) {
+    char *content;
+    unsigned len, size = buf_grow_size(buf);
+
+    if (size == 0)
+        return -ECANCELED;
+    content = malloc(size);
+    if (content == NULL)
+        return -ECANCELED;
+
+    /* unwrap the ring */
+    len = buf->size - buf->pos;
+    if (len >= buf->count)
+        memcpy(content, buf->content + buf->pos, buf->count);
+    else {
+        memcpy(content, buf->content + buf->pos, len);
+        memcpy(content + len, buf->content, buf->count - len);
+    }
+    free(buf->content);
+    buf->content = content;
+    buf->size = size;
+    buf->pos = 0;
+    return 0;
+}
+
 /**
  * Put the 'car' into the 'buf'
  * returns:
@@ -123,13 +327,13 @@ static int buf_put_car(buf_t *buf, char car) {
     unsigned pos;
 
     pos = buf->count;
-    if (pos >= PROT_MAX_BUFFER_LENGTH)
+    if (pos >= buf->size && outbuf_grow(buf) < 0)
         return -ECANCELED;
 
     buf->count = pos + 1;
     pos += buf->pos;
-    if (pos >= PROT_MAX_BUFFER_LENGTH)
-        pos -= PROT_MAX_BUFFER_LENGTH;
+    if (pos >= buf->size)
+        pos -= buf->size;
     buf->content[pos] = car;
     return 0;
 }
@@ -141,53 +345,231 @@ static int buf_put_car(buf_t *buf, char car) {
  *  - -ECANCELED if there is not enought space in the buffer
  */
 static int buf_put_string(buf_t *buf, const char *string) {
-    unsigned pos, remain, escape = 0;
+    unsigned pos, remain, run, escape;
+    const char *head = string;
+    size_t length, headlen = strlen(string);
     char c;
 
+start:
     remain = buf->count;
     pos = buf->pos + remain;
-    if (pos >= PROT_MAX_BUFFER_LENGTH)
-        pos -= PROT_MAX_BUFFER_LENGTH;
-    remain = PROT_MAX_BUFFER_LENGTH - remain;
+    if (pos >= buf->size)
+        pos -= buf->size;
+    remain = buf->size - remain;
+    length = headlen;
 
     /* put all chars of the string */
-    while ((c = *string++)) {
-        /* escape special characters */
-        if (c == PROT_FIELD_SEPARATOR || c == PROT_RECORD_SEPARATOR)
-            escape = 1;
-        else if (c == PROT_ESCAPE)
-            escape = *string == 0
-                  || *string == PROT_FIELD_SEPARATOR
-                  || *string == PROT_RECORD_SEPARATOR
-                  || *string == PROT_ESCAPE;
+    while (length) {
+        /* copy the run of plain chars */
+        run = (unsigned)span_plain(string, length);
+        if (run) {
+            if (run > remain)
+                goto cancel;
+            if (run <= buf->size - pos)
+                memcpy(&buf->content[pos], string, run);
+            else {
+                memcpy(&buf->content[pos], string, buf->size - pos);
+                memcpy(buf->content, &string[buf->size - pos], run - (buf->size - pos));
+            }
+            pos += run;
+            if (pos >= buf->size)
+                pos -= buf->size;
+            remain -= run;
+            string += run;
+            length -= run;
+            if (!length)
+                break;
+        }
+
+        /* escape special characters, escape itself only when needed */
+        c = *string++;
+        length--;
+        escape = c != PROT_ESCAPE || is_special(*string) || *string == 0;
         if (escape) {
             if (!remain--)
                 goto cancel;
             buf->content[pos++] = PROT_ESCAPE;
-            if (pos == PROT_MAX_BUFFER_LENGTH)
+            if (pos == buf->size)
                 pos = 0;
-            escape = 0;
         }
         /* put the char */
         if (!remain--)
             goto cancel;
         buf->content[pos++] = c;
-        if (pos == PROT_MAX_BUFFER_LENGTH)
+        if (pos == buf->size)
             pos = 0;
     }
 
     /* record the new values */
-    buf->count = PROT_MAX_BUFFER_LENGTH - remain;
+    buf->count = buf->size - remain;
     return 0;
 
 cancel:
-    return -ECANCELED;
+    /* grow and restart, the count is unchanged until completion */
+    if (outbuf_grow(buf) < 0)
+        return -ECANCELED;
+    string = head;
+    goto start;
+}
+
+/**
+ * Put the 'count' bytes of 'data' into the 'buf'
+ * returns:
+ *  - 0 on success
+ *  - -ECANCELED if there is not enought space in the buffer
+ */
+static int buf_put_bytes(buf_t *buf, const void *data, unsigned count) {
+    unsigned pos, len;
+
+    while (buf->size - buf->count < count)
+        if (outbuf_grow(buf) < 0)
+            return -ECANCELED;
+
+    pos = buf->pos + buf->count;
+    if (pos >= buf->size)
+        pos -= buf->size;
+    len = buf->size - pos;
+    if (len >= count)
+        memcpy(buf->content + pos, data, count);
+    else {
+        memcpy(buf->content + pos, data, len);
+        memcpy(buf->content, (const char*)data + len, count - len);
+    }
+    buf->count += count;
+    return 0;
+}
+
+/**
+ * Set the char at 'offset' of the content of the ring 'buf'
+ */
+static void buf_set_car(buf_t *buf, unsigned offset, char car) {
+    offset += buf->pos;
+    if (offset >= buf->size)
+        offset -= buf->size;
+    buf->content[offset] = car;
+}
+
+/**
+ * close the file descriptors of 'fdq' and empty it
+ */
+static void fdq_clear(fdq_t *fdq) {
+    while (fdq->count)
+        close(fdq->fds[--fdq->count]);
+}
+
+/**
+ * add 'fd' at the end of 'fdq' or close it if 'fdq' is full
+ * returns 0 on success or -EMFILE if 'fdq' is full
+ */
+static int fdq_push(fdq_t *fdq, int fd) {
+    if (fdq->count >= PROT_MAX_FDS) {
+        close(fd);
+        return -EMFILE;
+    }
+    fdq->fds[fdq->count++] = fd;
+    return 0;
+}
+
+/**
+ * remove the first file descriptor of 'fdq' and return it
+ * or return -ENOENT if 'fdq' is empty
+ */
+static int fdq_shift(fdq_t *fdq) {
+    int fd;
+
+    if (fdq->count == 0)
+        return -ENOENT;
+    fd = fdq->fds[0];
+    memmove(&fdq->fds[0], &fdq->fds[1], --fdq->count * sizeof fdq->fds[0]);
+    memmove(&fdq->ends[0], &fdq->ends[1], fdq->count * sizeof fdq->ends[0]);
+    return fd;
+}
+
+/**
+ * close the file descriptors of 'fdq' received with the data before 'pos'
+ * of the input buffer that is cropped of 'pos' bytes
+ */
+static void fdq_crop(fdq_t *fdq, unsigned pos) {
+    unsigned idx;
+
+    while (fdq->count && fdq->ends[0] <= pos)
+        close(fdq_shift(fdq));
+    for (idx = 0 ; idx < fdq->count ; idx++)
+        fdq->ends[idx] -= pos;
+}
+
+/**
+ * write the iovec 'vec' of 'n' items to the socket 'fd'
+ * and pass with it the file descriptors of 'fdq'
+ */
+static ssize_t send_fds(int fd, struct iovec *vec, int n, fdq_t *fdq) {
+    union {
+        struct cmsghdr cmsg;
+        char space[CMSG_SPACE(PROT_MAX_FDS * sizeof(int))];
+    } control;
+    struct msghdr msg;
+    ssize_t rc;
+
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = vec;
+    msg.msg_iovlen = (size_t)n;
+    msg.msg_control = &control;
+    msg.msg_controllen = CMSG_SPACE(fdq->count * sizeof(int));
+    memset(&control, 0, sizeof control);
+    control.cmsg.cmsg_level = SOL_SOCKET;
+    control.cmsg.cmsg_type = SCM_RIGHTS;
+    control.cmsg.cmsg_len = CMSG_LEN(fdq->count * sizeof(int));
+    memcpy(CMSG_DATA(&control.cmsg), fdq->fds, fdq->count * sizeof(int));
+
+    rc = sendmsg(fd, &msg, 0);
+    if (rc > 0)
+        fdq_clear(fdq); /* sent, the local copies are closed */
+    return rc;
+}
+
+/**
+ * read at most 'size' bytes of the socket 'fd' in 'data'
+ * and add the file descriptors passed with them to 'fdq'
+ */
+static ssize_t recv_fds(int fd, char *data, size_t size, fdq_t *fdq) {
+    union {
+        struct cmsghdr cmsg;
+        char space[CMSG_SPACE(PROT_MAX_FDS * sizeof(int))];
+    } control;
+    struct msghdr msg;
+    struct iovec vec;
+    struct cmsghdr *cmsg;
+    ssize_t rc;
+    size_t idx, count;
+    int rfd;
+
+    vec.iov_base = data;
+    vec.iov_len = size;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    msg.msg_control = &control;
+    msg.msg_controllen = sizeof control;
+
+    rc = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    if (rc >= 0) {
+        for (cmsg = CMSG_FIRSTHDR(&msg) ; cmsg != NULL ; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (idx = 0 ; idx < count ; idx++) {
+                    memcpy(&rfd, CMSG_DATA(cmsg) + idx * sizeof(int), sizeof(int));
+                    fdq_push(fdq, rfd);
+                }
+            }
+        }
+    }
+    return rc;
 }
 
 /**
  * write part of the content of 'buf' to 'fd'
  */
-static int buf_write_length(buf_t *buf, int fd, unsigned count)
+static int buf_write_length(buf_t *buf, int fd, unsigned count, fdq_t *fdq)
 {
     int n;
     ssize_t rc;
@@ -205,11 +587,11 @@ static int buf_write_length(buf_t *buf, int fd, unsigned count)
 
     /* prepare the iovec */
     vec[0].iov_base = buf->content + buf->pos;
-    if (buf->pos + count <= PROT_MAX_BUFFER_LENGTH) {
+    if (buf->pos + count <= buf->size) {
         vec[0].iov_len = count;
         n = 1;
     } else {
-        vec[0].iov_len = PROT_MAX_BUFFER_LENGTH - buf->pos;
+        vec[0].iov_len = buf->size - buf->pos;
         vec[1].iov_base = buf->content;
         vec[1].iov_len = count - vec[0].iov_len;
         n = 2;
@@ -217,7 +599,7 @@ static int buf_write_length(buf_t *buf, int fd, unsigned count)
 
     /* write the buffers */
     do {
-        rc = writev(fd, vec, n);
+        rc = fdq->count ? send_fds(fd, vec, n, fdq) : writev(fd, vec, n);
     } while (rc < 0 && errno == EINTR);
 
     /* check error */
@@ -227,8 +609,8 @@ static int buf_write_length(buf_t *buf, int fd, unsigned count)
         /* update the state */
         buf->count -= (unsigned)rc;
         buf->pos += (unsigned)rc;
-        if (buf->pos >= PROT_MAX_BUFFER_LENGTH)
-            buf->pos -= PROT_MAX_BUFFER_LENGTH;
+        if (buf->pos >= buf->size)
+            buf->pos -= buf->size;
     }
 
     return (int)rc;
@@ -239,7 +621,7 @@ static int buf_write_length(buf_t *buf, int fd, unsigned count)
  */
 static void buf_get_fields(buf_t *buf, fields_t *fields) {
     char c;
-    unsigned read, write;
+    unsigned read, write, run;
 
     /* advance the pos after the end */
     assert(buf->content[buf->pos] == PROT_RECORD_SEPARATOR);
@@ -250,6 +632,14 @@ static void buf_get_fields(buf_t *buf, fields_t *fields) {
     read = write = 0;
     fields->fields[0] = buf->content;
     for (;;) {
+        /* move the run of plain chars, the end of record stops it */
+        run = (unsigned)span_plain(&buf->content[read], buf->pos - read);
+        if (run) {
+            if (write != read)
+                memmove(&buf->content[write], &buf->content[read], run);
+            read += run;
+            write += run;
+        }
         c = buf->content[read++];
         switch (c) {
             case PROT_FIELD_SEPARATOR: /* field separator */
@@ -276,6 +666,49 @@ static void buf_get_fields(buf_t *buf, fields_t *fields) {
     }
 }
 
+/**
+ * get the 'fields' of the binary record at start of 'buf'.
+ * The lengths are checked but the content is not scanned.
+ * returns:
+ *  - 1 when a record is got, pos is then set after it
+ *  - 0 when the record isn't fully received
+ *  - -EMSGSIZE when the record is too big
+ *  - -EBADMSG when the record is malformed
+ */
+static int buf_get_binary_fields(buf_t *buf, fields_t *fields) {
+    const unsigned char *data = (const unsigned char*)buf->content;
+    unsigned end, pos, len;
+    int count;
+
+    /* get the length of the record */
+    if (buf->count < PROT_BINARY_RECORD_HEADER)
+        return 0;
+    end = (unsigned)data[0] << 24 | (unsigned)data[1] << 16
+        | (unsigned)data[2] << 8 | (unsigned)data[3];
+    if (end > buf->limit - PROT_BINARY_RECORD_HEADER)
+        return -EMSGSIZE;
+    end += PROT_BINARY_RECORD_HEADER;
+    if (buf->count < end)
+        return 0;
+
+    /* get the fields */
+    count = 0;
+    pos = PROT_BINARY_RECORD_HEADER;
+    while (pos < end) {
+        if (count == PROT_MAX_FIELDS || end - pos <= PROT_BINARY_FIELD_HEADER)
+            return -EBADMSG;
+        len = (unsigned)data[pos] << 8 | (unsigned)data[pos + 1];
+        pos += PROT_BINARY_FIELD_HEADER;
+        if (end - pos <= len || data[pos + len] != 0)
+            return -EBADMSG;
+        fields->fields[count++] = &buf->content[pos];
+        pos += len + 1;
+    }
+    fields->count = count;
+    buf->pos = end;
+    return 1;
+}
+
 /**
  * Advance pos of 'buf' until end of record RS found in buffer.
  * return 1 if found or 0 if not found
@@ -283,17 +716,22 @@ static void buf_get_fields(buf_t *buf, fields_t *fields) {
 static int buf_scan_end_record(buf_t *buf) {
     unsigned nesc;
 
+    const char *rs;
+
     /* search the next RS */
     while (buf->pos < buf->count) {
-        if (buf->content[buf->pos] == PROT_RECORD_SEPARATOR) {
-            /* check whether RS is escaped */
-            nesc = 0;
-            while (buf->pos > nesc && buf->content[buf->pos - (nesc + 1)] == PROT_ESCAPE) nesc++;
-            if ((nesc & 1) == 0)
-                return 1; /* not escaped */
-        }
+        rs = memchr(&buf->content[buf->pos], PROT_RECORD_SEPARATOR, buf->count - buf->pos);
+        if (rs == NULL)
+            break;
+        buf->pos = (unsigned)(rs - buf->content);
+        /* check whether RS is escaped */
+        nesc = 0;
+        while (buf->pos > nesc && buf->content[buf->pos - (nesc + 1)] == PROT_ESCAPE) nesc++;
+        if ((nesc & 1) == 0)
+            return 1; /* not escaped */
         buf->pos++;
     }
+    buf->pos = buf->count;
     return 0;
 }
 
@@ -308,24 +746,37 @@ static void buf_crop(buf_t *buf) {
 }
 
 /**
- * read input 'buf' from 'fd'
- * 
+ * read input 'buf' from 'fd', growing the buffer if 'grow' is not zero
+ * and receiving the passed file descriptors in 'fdq' if not NULL
  */
-static int inbuf_read(buf_t *buf, int fd) {
+static int inbuf_read(buf_t *buf, int fd, int grow, fdq_t *fdq) {
     ssize_t szr;
+    unsigned nfds;
     int rc;
 
-    if (buf->count == PROT_MAX_BUFFER_LENGTH)
-        return -ENOBUFS;
+    if (buf->count == buf->size) {
+        if (!grow)
+            return -ENOBUFS;
+        rc = inbuf_grow(buf);
+        if (rc < 0)
+            return rc;
+    }
 
+    nfds = fdq == NULL ? 0 : fdq->count;
     do {
-        szr = read(fd, buf->content + buf->count, PROT_MAX_BUFFER_LENGTH - buf->count);
+        if (fdq == NULL)
+            szr = read(fd, buf->content + buf->count, buf->size - buf->count);
+        else
+            szr = recv_fds(fd, buf->content + buf->count, buf->size - buf->count, fdq);
     } while (szr < 0 && errno == EINTR);
     if (szr < 0)
         rc = -(errno == EWOULDBLOCK ? EAGAIN : errno);
     else {
         rc = (int)szr;
         buf->count += (unsigned)rc;
+        /* the file descriptors are attached to the record of the last byte received */
+        for ( ; nfds < (fdq == NULL ? 0 : fdq->count) ; nfds++)
+            fdq->ends[nfds] = buf->count;
     }
 
     return rc;
@@ -340,15 +791,42 @@ int prot_create(prot_t **prot) {
     if (p == NULL)
         return -ENOMEM;
 
+    /* allocation of the buffers */
+    if (buf_init(&p->inbuf) < 0)
+        goto error;
+    if (buf_init(&p->outbuf) < 0)
+        goto error2;
+
     /* initialisation of the structure */
+    p->infds.count = p->outfds.count = 0;
     prot_reset(p);
 
     /* terminate */
     return 0;
+
+error2:
+    free(p->inbuf.content);
+error:
+    free(p);
+    *prot = NULL;
+    return -ENOMEM;
 }
 
 /* see prot.h */
-void prot_destroy(prot_t *prot) { free(prot); }
+void prot_destroy(prot_t *prot) {
+    fdq_clear(&prot->infds);
+    fdq_clear(&prot->outfds);
+    free(prot->inbuf.content);
+    free(prot->outbuf.content);
+    free(prot);
+}
+
+/* see prot.h */
+void prot_set_max_buffer_length(prot_t *prot, unsigned length) {
+    if (length < PROT_MIN_BUFFER_LENGTH)
+        length = PROT_MIN_BUFFER_LENGTH;
+    prot->inbuf.limit = prot->outbuf.limit = length;
+}
 
 /* see prot.h */
 void prot_reset(prot_t *prot) {
@@ -358,6 +836,10 @@ void prot_reset(prot_t *prot) {
     prot->outfields = prot->wrokcnt = 0;
     prot->fields.count = -1;
     prot->allow_empty = 0;
+    prot->binary = 0;
+    prot->notsock = 0;
+    fdq_clear(&prot->infds);
+    fdq_clear(&prot->outfds);
 }
 
 /* see prot.h */
@@ -372,6 +854,18 @@ void prot_set_allow_empty(prot_t *prot, int value)
     prot->allow_empty = !!value;
 }
 
+/* see prot.h */
+int prot_is_binary(prot_t *prot)
+{
+    return prot->binary;
+}
+
+/* see prot.h */
+void prot_set_binary(prot_t *prot, int value)
+{
+    prot->binary = !!value;
+}
+
 /* see prot.h */
 void prot_put_cancel(prot_t *prot) {
     if (prot->outfields) {
@@ -383,8 +877,26 @@ void prot_put_cancel(prot_t *prot) {
 /* see prot.h */
 int prot_put_end(prot_t *prot) {
     int rc = 0;
-
-    if (prot->outfields || prot->allow_empty) {
+    unsigned len, off;
+
+    if (prot->binary) {
+        if (prot->outfields || prot->allow_empty) {
+            if (!prot->outfields)
+                rc = buf_put_bytes(&prot->outbuf, "\0\0\0\0", PROT_BINARY_RECORD_HEADER);
+            if (rc == 0) {
+                /* set the length of the record in its header */
+                off = prot->wrokcnt;
+                len = prot->outbuf.count - off - PROT_BINARY_RECORD_HEADER;
+                buf_set_car(&prot->outbuf, off, (char)(len >> 24));
+                buf_set_car(&prot->outbuf, off + 1, (char)(len >> 16));
+                buf_set_car(&prot->outbuf, off + 2, (char)(len >> 8));
+                buf_set_car(&prot->outbuf, off + 3, (char)len);
+                prot->wrokcnt = prot->outbuf.count;
+                prot->outfields = 0;
+            }
+        }
+    }
+    else if (prot->outfields || prot->allow_empty) {
         rc = buf_put_car(&prot->outbuf, PROT_RECORD_SEPARATOR);
         if (rc == 0) {
             prot->wrokcnt = prot->outbuf.count;
@@ -397,6 +909,27 @@ int prot_put_end(prot_t *prot) {
 /* see prot.h */
 int prot_put_field(prot_t *prot, const char *field) {
     int rc = 0;
+    size_t len;
+    unsigned off;
+    char head[PROT_BINARY_RECORD_HEADER + PROT_BINARY_FIELD_HEADER];
+
+    if (prot->binary) {
+        len = field ? strlen(field) : 0;
+        if (len > PROT_BINARY_FIELD_MAX)
+            return -EINVAL;
+        off = 0;
+        if (prot->outfields++ == 0) {
+            /* reserve the header of the record */
+            memset(head, 0, PROT_BINARY_RECORD_HEADER);
+            off = PROT_BINARY_RECORD_HEADER;
+        }
+        head[off++] = (char)(len >> 8);
+        head[off++] = (char)len;
+        rc = buf_put_bytes(&prot->outbuf, head, off);
+        if (rc == 0)
+            rc = buf_put_bytes(&prot->outbuf, field ? field : "", (unsigned)len + 1);
+        return rc;
+    }
 
     if (prot->outfields++)
         rc = buf_put_car(&prot->outbuf, PROT_FIELD_SEPARATOR);
@@ -467,7 +1000,7 @@ int prot_should_write(prot_t *prot)
 /* see prot.h */
 int prot_write(prot_t *prot, int fdout)
 {
-    int result = buf_write_length(&prot->outbuf, fdout, prot->wrokcnt);
+    int result = buf_write_length(&prot->outbuf, fdout, prot->wrokcnt, &prot->outfds);
     if (result > 0)
         prot->wrokcnt -= (unsigned)result;
     return result;
@@ -475,18 +1008,53 @@ int prot_write(prot_t *prot, int fdout)
 
 /* see prot.h */
 int prot_can_read(prot_t *prot) {
-    return prot->inbuf.count < PROT_MAX_BUFFER_LENGTH;
+    return prot->inbuf.count < prot->inbuf.size
+        || prot->inbuf.size < prot->inbuf.limit;
 }
 
 /* see prot.h */
 int prot_read(prot_t *prot, int fdin) {
-    return inbuf_read(&prot->inbuf, fdin);
+    int rc;
+
+    /* don't move the content while fields are pending */
+    rc = inbuf_read(&prot->inbuf, fdin, prot->fields.count < 0,
+                    prot->notsock ? NULL : &prot->infds);
+    if (rc == -ENOTSOCK) {
+        /* plain files and pipes don't pass file descriptors */
+        prot->notsock = 1;
+        rc = inbuf_read(&prot->inbuf, fdin, prot->fields.count < 0, NULL);
+    }
+    return rc;
+}
+
+/* see prot.h */
+int prot_put_fd(prot_t *prot, int fd) {
+    int dfd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dfd < 0)
+        return -errno;
+    return fdq_push(&prot->outfds, dfd);
+}
+
+/* see prot.h */
+int prot_get_fd(prot_t *prot) {
+    if (prot->fields.count < 0 || prot->infds.count == 0 || prot->infds.ends[0] > prot->inbuf.pos)
+        return -ENOENT;
+    return fdq_shift(&prot->infds);
 }
 
 /* see prot.h */
 int prot_get(prot_t *prot, const char ***fields) {
+    int rc;
+
     for (;;) {
-        if (prot->fields.count < 0) {
+        if (prot->binary) {
+            if (prot->fields.count < 0) {
+                rc = buf_get_binary_fields(&prot->inbuf, &prot->fields);
+                if (rc <= 0)
+                    return rc < 0 ? rc : -EAGAIN;
+            }
+        }
+        else if (prot->fields.count < 0) {
             if (!buf_scan_end_record(&prot->inbuf))
                 return prot_can_read(prot) ? -EAGAIN : -EMSGSIZE;
             buf_get_fields(&prot->inbuf, &prot->fields);
@@ -504,6 +1072,7 @@ int prot_get(prot_t *prot, const char ***fields) {
 /* see prot.h */
 void prot_next(prot_t *prot) {
     if (prot->fields.count >= 0) {
+        fdq_crop(&prot->infds, prot->inbuf.pos);
         buf_crop(&prot->inbuf);
         prot->fields.count = -1;
     }
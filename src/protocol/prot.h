@@ -45,6 +45,43 @@ extern int prot_create(prot_t **prot);
  */
 extern void prot_destroy(prot_t *prot);
 
+/**
+ * @brief Set the maximum length of the buffers of 'prot'.
+ * The buffers grow at need until that length, that is
+ * the maximum length of a record. The default is
+ * PROT_MAX_BUFFER_LENGTH. Lengths lower than
+ * PROT_MIN_BUFFER_LENGTH are raised to it.
+ *
+ * @param prot the protocol handler
+ * @param length the maximum length
+ */
+extern void prot_set_max_buffer_length(prot_t *prot, unsigned length);
+
+/**
+ * @brief Check whether protocol handler 'prot' uses
+ * the binary framing of records or the text framing
+ *
+ * @param prot the protocol handler
+ * @return 0 for text framing or 1 for binary framing
+ */
+extern int prot_is_binary(prot_t *prot);
+
+/**
+ * @brief Set whether protocol handler 'prot' uses the binary
+ * framing of records (not the default) or the text framing.
+ * The change applies to the records put or got after the call.
+ *
+ * In binary framing, records are made of a header of 4 bytes
+ * giving the length of the remaining of the record, followed by
+ * the fields. Each field is made of a header of 2 bytes giving
+ * its length followed by its bytes and a terminating zero. The
+ * lengths are unsigned big endian integers. Nothing is escaped.
+ *
+ * @param prot the protocol handler
+ * @param value 0 for text framing or not 0 for binary framing
+ */
+extern void prot_set_binary(prot_t *prot, int value);
+
 /**
  * @brief Reset the protocol handler 'prot'.
  * Buffers are cleared and allow_empty reset to no (0).
@@ -66,7 +103,8 @@ extern int prot_is_empty_allowed(prot_t *prot);
 extern void prot_set_allow_empty(prot_t *prot, int value);
 
 /**
- * @brief Reset the protocol handler 'prot'
+ * @brief Reset the protocol handler 'prot'.
+ * Pending file descriptors are closed.
  *
  * @param prot the protocol handler
  */
@@ -161,7 +199,8 @@ extern int prot_write(prot_t *prot, int fdout);
 extern int prot_can_read(prot_t *prot);
 
 /**
- * Read data from the input file fdin
+ * Read data from the input file fdin. When fdin is a socket,
+ * the file descriptors passed along are queued for prot_get_fd.
  *
  * @param prot the protocol handler
  * @param fdin the file to read
@@ -169,6 +208,30 @@ extern int prot_can_read(prot_t *prot);
  */
 extern int prot_read(prot_t *prot, int fdin);
 
+/**
+ * @brief Pass a copy of the file descriptor 'fd' with the next
+ * write of 'prot'. The receiver gets it with prot_get_fd when
+ * reading the bytes of that write. At most PROT_MAX_FDS file
+ * descriptors can be pending.
+ *
+ * @param prot the protocol handler
+ * @param fd the file descriptor to pass
+ * @return 0 on success or a negative -errno value,
+ *         -EMFILE when too many file descriptors are pending
+ */
+extern int prot_put_fd(prot_t *prot, int fd);
+
+/**
+ * @brief Get the oldest file descriptor passed with the record currently
+ * got by 'prot'. The caller becomes owner of the returned file descriptor.
+ * A file descriptor is attached to the record of the last byte received
+ * with it, the ones of a record that are not got are closed by prot_next.
+ *
+ * @param prot the protocol handler
+ * @return the file descriptor or -ENOENT if none was passed with the record
+ */
+extern int prot_get_fd(prot_t *prot);
+
 /**
  * @brief Get the currently received fields and its count
  *
@@ -176,6 +239,7 @@ extern int prot_read(prot_t *prot, int fdin);
  * @param fields where to store the array of received fields (can be NULL)
  * @return the count of fields or -EAGAIN if no field is available
  *         or -EMSGSIZE when buffer is full but record didn't end
+ *         or -EBADMSG when a binary record is malformed
  */
 extern int prot_get(prot_t *prot, const char ***fields);
 
@@ -25,22 +25,88 @@
 #include "sec-lsm-manager-protocol.h"
 
 #include <stdlib.h>
+#include <string.h>
 
+const char _async_[] = "async";
 const char _clear_[] = "clear";
 const char _display_[] = "display";
 const char _done_[] = "done";
 const char _error_[] = "error";
+const char _failed_[] = "failed";
 const char _id_[] = "id";
 const char _install_[] = "install";
+const char _installed_[] = "installed";
 const char _log_[] = "log";
+const char _manifest_[] = "manifest";
 const char _off_[] = "off";
 const char _on_[] = "on";
 const char _path_[] = "path";
+const char _pending_[] = "pending";
 const char _permission_[] = "permission";
 const char _plug_[] = "plug";
 const char _sec_lsm_manager_[] = "sec-lsm-manager";
+const char _sec_lsm_manager_manifest_[] = "sec-lsm-manager-manifest";
+const char _status_[] = "status";
 const char _string_[] = "string";
 const char _uninstall_[] = "uninstall";
+const char _wait_[] = "wait";
+
+/** names of the opcodes */
+static const char *const opcode_names[opcode_count] = {
+    [opcode_none]       = NULL,
+    [opcode_clear]      = _clear_,
+    [opcode_display]    = _display_,
+    [opcode_id]         = _id_,
+    [opcode_install]    = _install_,
+    [opcode_log]        = _log_,
+    [opcode_path]       = _path_,
+    [opcode_permission] = _permission_,
+    [opcode_plug]       = _plug_,
+    [opcode_status]     = _status_,
+    [opcode_uninstall]  = _uninstall_,
+    [opcode_wait]       = _wait_,
+    [opcode_done]       = _done_,
+    [opcode_error]      = _error_,
+    [opcode_string]     = _string_,
+    [opcode_manifest]   = _manifest_
+};
+
+/** encoded opcodes, the value of the character is the opcode */
+static const char opcode_codes[opcode_count][2] = {
+    "", "\001", "\002", "\003", "\004", "\005", "\006", "\007",
+    "\010", "\011", "\012", "\013", "\014", "\015", "\016", "\017"
+};
+
+/* see sec-lsm-manager-protocol.h */
+unsigned sec_lsm_manager_opcode_of_name(const char *name) {
+    unsigned opcode;
+
+    /* fast path for the predefined names */
+    for (opcode = 1 ; opcode < opcode_count ; opcode++)
+        if (name == opcode_names[opcode])
+            return opcode;
+
+    for (opcode = 1 ; opcode < opcode_count ; opcode++)
+        if (!strcmp(name, opcode_names[opcode]))
+            return opcode;
+    return opcode_none;
+}
+
+/* see sec-lsm-manager-protocol.h */
+unsigned sec_lsm_manager_opcode_of_code(const char *code) {
+    unsigned opcode = (unsigned char)code[0];
+    return opcode != opcode_none && opcode < opcode_count && code[1] == 0 ? opcode : opcode_none;
+}
+
+/* see sec-lsm-manager-protocol.h */
+const char *sec_lsm_manager_opcode_name(unsigned opcode) {
+    return opcode < opcode_count ? opcode_names[opcode] : NULL;
+}
+
+/* see sec-lsm-manager-protocol.h */
+const char *sec_lsm_manager_opcode_code(unsigned opcode) {
+    return opcode_codes[opcode < opcode_count ? opcode : opcode_none];
+}
 
 
 #if !defined(SEC_LSM_MANAGER_SOCKET_SCHEME)
@@ -25,21 +25,88 @@
 #ifndef SEC_LSM_MANAGER_PROTOCOL_H
 #define SEC_LSM_MANAGER_PROTOCOL_H
 
+extern const char _async_[];
 extern const char _clear_[];
 extern const char _display_[];
 extern const char _done_[];
 extern const char _error_[];
+extern const char _failed_[];
 extern const char _id_[];
 extern const char _install_[];
+extern const char _installed_[];
 extern const char _log_[];
+extern const char _manifest_[];
 extern const char _off_[];
 extern const char _on_[];
 extern const char _path_[];
+extern const char _pending_[];
 extern const char _permission_[];
 extern const char _plug_[];
 extern const char _sec_lsm_manager_[];
+extern const char _sec_lsm_manager_manifest_[];
+extern const char _status_[];
 extern const char _string_[];
 extern const char _uninstall_[];
+extern const char _wait_[];
+
+/**
+ * opcodes replacing the names of requests and replies
+ * in the version 2 of the protocol
+ */
+enum sec_lsm_manager_opcode {
+    opcode_none = 0,
+    opcode_clear,
+    opcode_display,
+    opcode_id,
+    opcode_install,
+    opcode_log,
+    opcode_path,
+    opcode_permission,
+    opcode_plug,
+    opcode_status,
+    opcode_uninstall,
+    opcode_wait,
+    opcode_done,
+    opcode_error,
+    opcode_string,
+    opcode_manifest,
+    opcode_count
+};
+
+/**
+ * @brief Get the opcode of the name of a request or reply
+ *
+ * @param[in] name the name
+ * @return the opcode or opcode_none if not found
+ */
+extern unsigned sec_lsm_manager_opcode_of_name(const char *name);
+
+/**
+ * @brief Get the opcode of the encoded opcode of a request or reply
+ *
+ * @param[in] code the encoded opcode as received
+ * @return the opcode or opcode_none if not valid
+ */
+extern unsigned sec_lsm_manager_opcode_of_code(const char *code);
+
+/**
+ * @brief Get the name of an opcode
+ *
+ * @param[in] opcode the opcode
+ * @return the name of the opcode (NULL for opcode_none)
+ */
+extern const char *sec_lsm_manager_opcode_name(unsigned opcode);
+
+/**
+ * @brief Get the encoded opcode to transmit for an opcode
+ *
+ * @param[in] opcode the opcode
+ * @return the encoded opcode, a string of one character
+ */
+extern const char *sec_lsm_manager_opcode_code(unsigned opcode);
+
+/** version of the format of manifests */
+#define SEC_LSM_MANAGER_MANIFEST_VERSION "1"
 
 /* predefined names */
 extern const char sec_lsm_manager_default_socket_scheme[];
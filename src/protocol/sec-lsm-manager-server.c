@@ -35,32 +35,59 @@
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/timerfd.h>
 
 #include "client.h"
 #include "log.h"
 #include "pollitem.h"
 #include "sec-lsm-manager-protocol.h"
 #include "socket.h"
+#include "worker.h"
 
 #ifndef MAX_CLIENT_COUNT
 #define MAX_CLIENT_COUNT 3
 #endif
 
+#ifndef CLIENT_TABLE_INCREMENT
+#define CLIENT_TABLE_INCREMENT 4
+#endif
+
 /** log of the protocol */
 bool sec_lsm_manager_server_log = false;
 
-struct client
+/** edge triggered polling of the clients */
+bool sec_lsm_manager_server_edge_triggered = false;
+
+typedef struct sec_lsm_manager_server_client server_client_t;
+
+/** structure for a client slot of the server */
+struct sec_lsm_manager_server_client
 {
-    /** the client */
+    /** the client or NULL when the slot is free */
     client_t *client;
 
-    /** pollfd */
-    int pollfd;
+    /** the server of the slot */
+    sec_lsm_manager_server_t *server;
+
+    /** next free slot when the slot is free */
+    server_client_t *next_free;
+
+    /** previous slot in the list of idle clients */
+    server_client_t *idle_prev;
+
+    /** next slot in the list of idle clients */
+    server_client_t *idle_next;
+
+    /** is the slot in the list of idle clients ? */
+    bool idle_linked;
 
     /** polling callback */
     pollitem_t pollitem;
 
-    /** last query time */
+    /** the events currently polled */
+    uint32_t events;
+
+    /** last query time (monotonic seconds) */
     time_t lasttime;
 };
 
@@ -81,12 +108,327 @@ struct sec_lsm_manager_server {
     /** the server socket */
     pollitem_t pollitem;
 
-    /** the clients */
-    struct client clients[MAX_CLIENT_COUNT];
+    /** maximum count of simultaneous clients */
+    unsigned max_clients;
+
+    /** current count of connected clients */
+    unsigned nr_clients;
+
+    /** count of allocated slots */
+    unsigned nr_slots;
+
+    /** allocated size of the table of slots */
+    unsigned sz_slots;
+
+    /** the table of slots, slots are never moved once allocated */
+    server_client_t **slots;
+
+    /** list of the free slots */
+    server_client_t *free_slots;
+
+    /** list of the slots released during the current dispatch */
+    server_client_t *released_slots;
+
+    /** the workers running the actions or NULL */
+    worker_pool_t *workers;
+
+    /** polling of the completion of the workers */
+    pollitem_t workers_pollitem;
+
+    /** shut off time of idle clients in seconds (negative for never) */
+    int shutofftime;
+
+    /** the current time (monotonic seconds) if now_valid */
+    time_t now;
+
+    /** is now valid for the current batch of events ? */
+    bool now_valid;
+
+    /** the idle timer (a timerfd) */
+    pollitem_t timer_pollitem;
+
+    /** the time when the timer is armed (0 when not armed) */
+    time_t timer_armed;
+
+    /** oldest idle client, first to expire */
+    server_client_t *idle_head;
+
+    /** newest idle client, last to expire */
+    server_client_t *idle_tail;
 };
 
 /**
- * @brief handle client requests
+ * @brief Get the current monotonic time in seconds, the clock
+ * is read once per batch of events
+ *
+ * @param[in] server the server
+ * @return the current time
+ */
+__nonnull() __wur
+static time_t get_now(sec_lsm_manager_server_t *server)
+{
+    struct timespec ts;
+
+    if (!server->now_valid) {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        server->now = ts.tv_sec;
+        server->now_valid = true;
+    }
+    return server->now;
+}
+
+/**
+ * @brief Remove the slot from the list of idle clients
+ *
+ * @param[in] slot the slot to remove
+ */
+__nonnull()
+static void idle_unlink(server_client_t *slot)
+{
+    sec_lsm_manager_server_t *server = slot->server;
+
+    if (slot->idle_linked) {
+        if (slot->idle_prev == NULL)
+            server->idle_head = slot->idle_next;
+        else
+            slot->idle_prev->idle_next = slot->idle_next;
+        if (slot->idle_next == NULL)
+            server->idle_tail = slot->idle_prev;
+        else
+            slot->idle_next->idle_prev = slot->idle_prev;
+        slot->idle_linked = false;
+    }
+}
+
+/**
+ * @brief Record the activity of the client of the slot: set its time
+ * to now and move it at the end of the list of idle clients. Because
+ * the delay of expiration is the same for all clients, the list stays
+ * ordered by expiration time.
+ *
+ * @param[in] slot the slot of the client
+ */
+__nonnull()
+static void idle_touch(server_client_t *slot)
+{
+    sec_lsm_manager_server_t *server = slot->server;
+
+    idle_unlink(slot);
+    slot->lasttime = get_now(server);
+    slot->idle_next = NULL;
+    slot->idle_prev = server->idle_tail;
+    if (server->idle_tail == NULL)
+        server->idle_head = slot;
+    else
+        server->idle_tail->idle_next = slot;
+    server->idle_tail = slot;
+    slot->idle_linked = true;
+}
+
+/**
+ * @brief Arm the idle timer for the expiration of the oldest idle client
+ *
+ * @param[in] server the server
+ */
+__nonnull()
+static void update_timer(sec_lsm_manager_server_t *server)
+{
+    struct itimerspec its = { .it_interval = { 0, 0 }, .it_value = { 0, 0 } };
+    time_t expire = 0;
+
+    if (server->idle_head != NULL && server->shutofftime >= 0)
+        expire = server->idle_head->lasttime + server->shutofftime + 1;
+    if (expire != server->timer_armed) {
+        its.it_value.tv_sec = expire;
+        if (timerfd_settime(server->timer_pollitem.fd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+            ERROR("can't arm idle timer: %s", strerror(errno));
+        server->timer_armed = expire;
+    }
+}
+
+/**
+ * @brief Get a free slot, allocating it if needed
+ *
+ * @param[in] server the server
+ * @return a free slot or NULL if none is available
+ */
+__nonnull() __wur
+static server_client_t *get_free_slot(sec_lsm_manager_server_t *server)
+{
+    server_client_t *slot, **slots;
+    unsigned size;
+
+    /* take a recycled slot */
+    slot = server->free_slots;
+    if (slot != NULL) {
+        server->free_slots = slot->next_free;
+        return slot;
+    }
+
+    /* check the limit */
+    if (server->nr_slots >= server->max_clients)
+        return NULL;
+
+    /* grow the table on need */
+    if (server->nr_slots == server->sz_slots) {
+        size = server->sz_slots + CLIENT_TABLE_INCREMENT;
+        if (size > server->max_clients)
+            size = server->max_clients;
+        slots = realloc(server->slots, size * sizeof *slots);
+        if (slots == NULL)
+            return NULL;
+        server->slots = slots;
+        server->sz_slots = size;
+    }
+
+    /* allocate a fresh slot */
+    slot = calloc(1, sizeof *slot);
+    if (slot != NULL) {
+        slot->server = server;
+        server->slots[server->nr_slots++] = slot;
+    }
+    return slot;
+}
+
+/**
+ * @brief Set whether the server is listening to incoming connections or not
+ *
+ * @param[in] server the server
+ * @param[in] deaf true to stop listening, false to listen
+ */
+__nonnull()
+static void set_deaf(sec_lsm_manager_server_t *server, bool deaf)
+{
+    int rc;
+
+    if (server->deaf != deaf) {
+        rc = pollitem_mod(&server->pollitem, deaf ? 0 : EPOLLIN, server->pollfd);
+        if (rc < 0) {
+            ERROR("unexpected server socket error");
+            sec_lsm_manager_server_stop(server, rc);
+        }
+        server->deaf = deaf;
+    }
+}
+
+/**
+ * @brief Release the client of the slot and put the slot in the list
+ * of released slots. Released slots are recycled after the dispatch
+ * of the current batch of events because events for the released
+ * client might still be pending in the batch.
+ *
+ * @param[in] slot the slot to release
+ */
+__nonnull()
+static void release_slot(server_client_t *slot)
+{
+    sec_lsm_manager_server_t *server = slot->server;
+
+    idle_unlink(slot);
+    pollitem_del(&slot->pollitem, server->pollfd);
+    client_destroy(slot->client);
+    slot->client = NULL;
+    slot->next_free = server->released_slots;
+    server->released_slots = slot;
+    server->nr_clients--;
+}
+
+/**
+ * @brief Recycle the released slots for accepting new clients
+ *
+ * @param[in] server the server
+ */
+__nonnull()
+static void recycle_released_slots(sec_lsm_manager_server_t *server)
+{
+    server_client_t *slot;
+
+    while ((slot = server->released_slots) != NULL) {
+        server->released_slots = slot->next_free;
+        slot->next_free = server->free_slots;
+        server->free_slots = slot;
+    }
+
+    /* accept new clients again */
+    if (server->nr_clients < server->max_clients)
+        set_deaf(server, false);
+}
+
+/**
+ * @brief Get the polling events of clients
+ *
+ * @param[in] events the events to poll
+ * @return the events to poll with the triggering mode
+ */
+__wur
+static uint32_t client_events(uint32_t events)
+{
+    return sec_lsm_manager_server_edge_triggered ? events | EPOLLET : events;
+}
+
+/**
+ * @brief Set the events polled for the client of the slot
+ *
+ * @param[in] slot the slot of the client
+ * @param[in] events the events to poll
+ * @return 0 in case of success or a negative -errno value
+ */
+__wur __nonnull()
+static int poll_client(server_client_t *slot, uint32_t events)
+{
+    if (slot->events != events) {
+        if (pollitem_mod(&slot->pollitem, events, slot->server->pollfd) < 0)
+            return -errno;
+        slot->events = events;
+    }
+    return 0;
+}
+
+/**
+ * @brief process the input of the client of the slot
+ *
+ * @param[in] slot the slot of the client
+ */
+__nonnull()
+static void process_client_input(server_client_t *slot)
+{
+    uint32_t events;
+    int rc = client_process_input(slot->client);
+    if (rc > 0 || rc == -EAGAIN) {
+        if (client_is_blocked(slot->client)) {
+            /* stop polling the input until the pending output is written */
+            idle_touch(slot);
+            events = client_events(EPOLLOUT);
+        }
+        else if (!client_is_busy(slot->client)) {
+            idle_touch(slot);
+            events = client_events(EPOLLIN);
+        }
+        else {
+            /* a busy client doesn't expire, stop polling its input
+               until completion of the running action */
+            idle_unlink(slot);
+            events = 0;
+        }
+        if (poll_client(slot, events) < 0)
+            release_slot(slot);
+    }
+    else
+        release_slot(slot);
+}
+
+/**
+ * @brief handle completion of an action of a client
+ *
+ * @param[in] closure the slot of the client
+ */
+static void on_client_resume(void *closure)
+{
+    process_client_input(closure);
+}
+
+/**
+ * @brief handle client requests and writability of its output
  *
  * @param[in] pollitem pollitem of requests
  * @param[in] events events receive
@@ -94,24 +436,59 @@ struct sec_lsm_manager_server {
  */
 static void on_client_event(pollitem_t *pollitem, uint32_t events, int pollfd)
 {
-    bool keep;
-    struct client *client = pollitem->closure;
+    server_client_t *slot = pollitem->closure;
 
+    (void)pollfd;
+    if (slot->client == NULL)
+        return; /* released in the current batch */
     if ((events & EPOLLHUP) != 0)
-        keep = false;
-    else {
-        int rc = client_process_input(client->client);
-        keep = rc > 0 || rc == -EAGAIN;
-    }
-    if (keep)
-        client->lasttime = time(NULL);
-    else {
-        pollitem_del(&client->pollitem, pollfd);
-        client_destroy(client->client);
-        client->client = NULL;
+        release_slot(slot);
+    else
+        process_client_input(slot);
+}
+
+/**
+ * @brief handle expiration of the idle timer, disconnecting expired clients
+ *
+ * @param[in] pollitem pollitem of the timer
+ * @param[in] events events receive
+ * @param[in] pollfd pollfd of the server
+ */
+static void on_timer_event(pollitem_t *pollitem, uint32_t events, int pollfd)
+{
+    sec_lsm_manager_server_t *server = pollitem->closure;
+    server_client_t *slot;
+    uint64_t count;
+    time_t trig;
+
+    (void)events;
+    (void)pollfd;
+    if (read(pollitem->fd, &count, sizeof count) < 0 && errno != EAGAIN)
+        ERROR("can't read idle timer: %s", strerror(errno));
+    server->timer_armed = 0;
+    trig = get_now(server) - server->shutofftime;
+    while ((slot = server->idle_head) != NULL && slot->lasttime < trig) {
+        DEBUG("disconnecting idle client");
+        release_slot(slot);
     }
 }
 
+/**
+ * @brief handle completion of jobs of the workers
+ *
+ * @param[in] pollitem pollitem of the workers
+ * @param[in] events events receive
+ * @param[in] pollfd pollfd of the server
+ */
+static void on_workers_event(pollitem_t *pollitem, uint32_t events, int pollfd)
+{
+    sec_lsm_manager_server_t *server = pollitem->closure;
+
+    (void)events;
+    (void)pollfd;
+    worker_pool_dispatch(server->workers);
+}
+
 /**
  * @brief handle server events
  *
@@ -122,9 +499,10 @@ static void on_client_event(pollitem_t *pollitem, uint32_t events, int pollfd)
 static void on_server_event(pollitem_t *pollitem, uint32_t events, int pollfd)
 {
     int servfd = pollitem->fd;
-    int fd, rc, idx;
+    int fd, rc;
     struct sockaddr saddr;
     socklen_t slen;
+    server_client_t *slot;
     sec_lsm_manager_server_t *server = (sec_lsm_manager_server_t *)pollitem->closure;
 
     /* is it a hangup? it shouldn't! */
@@ -139,59 +517,63 @@ static void on_server_event(pollitem_t *pollitem, uint32_t events, int pollfd)
         return;
 
     /* search a slot */
-    for(idx = 0 ; idx < MAX_CLIENT_COUNT ; idx++)
-        if (server->clients[idx].client == NULL)
-            break;
-
-    if (idx < MAX_CLIENT_COUNT) {
-        struct client *client = &server->clients[idx];
-
-        /* accept the connection */
-        slen = (socklen_t)sizeof(saddr);
-        fd = accept(servfd, &saddr, &slen);
-        if (fd < 0) {
-            ERROR("can't accept connection: %s", strerror(errno));
-            return;
-        }
-        fcntl(fd, F_SETFD, FD_CLOEXEC);
-        fcntl(fd, F_SETFL, O_NONBLOCK);
+    slot = get_free_slot(server);
+    if (slot == NULL) {
+        /* if full avoid accepting new clients until recycling of slots */
+        if (server->nr_slots >= server->max_clients)
+            set_deaf(server, true);
+        else
+            ERROR("can't allocate client slot");
+        return;
+    }
 
-        /* create a client for the connection */
-        rc = client_create(&client->client, fd, fd);
-        if (rc < 0) {
-            ERROR("can't create client connection: %d %s", -rc, strerror(-rc));
-            close(fd);
-            return;
-        }
+    /* accept the connection */
+    slen = (socklen_t)sizeof(saddr);
+    fd = accept(servfd, &saddr, &slen);
+    if (fd < 0) {
+        ERROR("can't accept connection: %s", strerror(errno));
+        goto release;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, O_NONBLOCK);
 
-        /* set pollitem */
-        client->lasttime = time(NULL);
-        client->pollitem.handler = on_client_event;
-        client->pollitem.closure = client;
-        client->pollitem.fd = fd;
+    /* create a client for the connection */
+    rc = client_create(&slot->client, fd, fd);
+    if (rc < 0) {
+        ERROR("can't create client connection: %d %s", -rc, strerror(-rc));
+        close(fd);
+        goto release;
+    }
 
-        /* connect the client to polling */
-        rc = pollitem_add(&client->pollitem, EPOLLIN, pollfd);
-        if (rc < 0) {
-            ERROR("can't poll client connection: %d %s", -rc, strerror(-rc));
-            client_destroy(client->client);
-            client->client = NULL;
-            return;
-        }
-        DEBUG("starting new client connection");
+    if (server->workers != NULL)
+        client_set_workers(slot->client, server->workers, on_client_resume, slot);
 
-        while(++idx < MAX_CLIENT_COUNT)
-            if (server->clients[idx].client == NULL)
-                return;
-    }
+    /* set pollitem */
+    slot->pollitem.handler = on_client_event;
+    slot->pollitem.closure = slot;
+    slot->pollitem.fd = fd;
 
-    /* if full avoid accepting new clients */
-    rc = pollitem_mod(&server->pollitem, 0, server->pollfd);
+    /* connect the client to polling, in edge triggered mode
+       client_process_input is relied on for reading until EAGAIN */
+    slot->events = client_events(EPOLLIN);
+    rc = pollitem_add(&slot->pollitem, slot->events, pollfd);
     if (rc < 0) {
-        ERROR("unexpected server socket error");
-        sec_lsm_manager_server_stop(server, rc);
+        ERROR("can't poll client connection: %d %s", -rc, strerror(-rc));
+        client_destroy(slot->client);
+        slot->client = NULL;
+        goto release;
     }
-    server->deaf = true;
+    DEBUG("starting new client connection");
+    idle_touch(slot);
+
+    /* if full avoid accepting new clients */
+    if (++server->nr_clients >= server->max_clients)
+        set_deaf(server, true);
+    return;
+
+release:
+    slot->next_free = server->free_slots;
+    server->free_slots = slot;
 }
 
 /**********************/
@@ -201,14 +583,25 @@ static void on_server_event(pollitem_t *pollitem, uint32_t events, int pollfd)
 /* see sec-lsm-manager-server.h */
 void sec_lsm_manager_server_destroy(sec_lsm_manager_server_t *server)
 {
-    int idx;
+    unsigned idx;
+    server_client_t *slot;
+
     pollitem_del(&server->pollitem, server->pollfd);
-    for (idx = 0 ; idx < MAX_CLIENT_COUNT ; idx++) {
-        if (server->clients[idx].client) {
-            pollitem_del(&server->clients[idx].pollitem, server->pollfd);
-            client_destroy(server->clients[idx].client);
+    for (idx = 0 ; idx < server->nr_slots ; idx++) {
+        slot = server->slots[idx];
+        if (slot->client) {
+            pollitem_del(&slot->pollitem, server->pollfd);
+            client_destroy(slot->client);
         }
+        free(slot);
+    }
+    free(server->slots);
+    if (server->workers != NULL) {
+        /* completes the actions of the destroyed clients */
+        pollitem_del(&server->workers_pollitem, server->pollfd);
+        worker_pool_destroy(server->workers);
     }
+    close(server->timer_pollitem.fd);
     close(server->pollitem.fd);
     close(server->pollfd);
     free(server);
@@ -216,7 +609,7 @@ void sec_lsm_manager_server_destroy(sec_lsm_manager_server_t *server)
 
 /* see sec-lsm-manager-server.h */
 __wur __nonnull((1))
-int sec_lsm_manager_server_create(sec_lsm_manager_server_t **pserver, const char *socket_spec)
+int sec_lsm_manager_server_create(sec_lsm_manager_server_t **pserver, const char *socket_spec, unsigned max_clients)
 {
     mode_t um;
     int rc = 0;
@@ -233,6 +626,7 @@ int sec_lsm_manager_server_create(sec_lsm_manager_server_t **pserver, const char
         rc = -ENOMEM;
         goto ret;
     }
+    server->max_clients = max_clients ? max_clients : MAX_CLIENT_COUNT;
 
     /* create the polling fd */
     server->pollfd = epoll_create1(EPOLL_CLOEXEC);
@@ -242,14 +636,30 @@ int sec_lsm_manager_server_create(sec_lsm_manager_server_t **pserver, const char
         goto error;
     }
 
+    /* create the idle timer */
+    server->timer_pollitem.fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (server->timer_pollitem.fd < 0) {
+        rc = -errno;
+        ERROR("create timer: %d %s", -rc, strerror(-rc));
+        goto error2;
+    }
+    server->timer_pollitem.handler = on_timer_event;
+    server->timer_pollitem.closure = server;
+    rc = pollitem_add(&server->timer_pollitem, EPOLLIN, server->pollfd);
+    if (rc < 0) {
+        rc = -errno;
+        ERROR("pollitem_add timer: %d %s", -rc, strerror(-rc));
+        goto error3;
+    }
+
     /* create the admin server socket */
     um = umask(017);
-    server->pollitem.fd = socket_open(socket_spec, MAX_CLIENT_COUNT);
+    server->pollitem.fd = socket_open(socket_spec, server->max_clients > INT_MAX ? INT_MAX : (int)server->max_clients);
     umask(um);
     if (server->pollitem.fd < 0) {
         rc = -errno;
         ERROR("create server socket %s: %d %s", socket_spec, -rc, strerror(-rc));
-        goto error2;
+        goto error3;
     }
 
     /* add the socket server to pollfd */
@@ -264,6 +674,8 @@ int sec_lsm_manager_server_create(sec_lsm_manager_server_t **pserver, const char
     rc = -errno;
     ERROR("pollitem_add socket: %d %s", -rc, strerror(-rc));
     close(server->pollitem.fd);
+error3:
+    close(server->timer_pollitem.fd);
 error2:
     close(server->pollfd);
 error:
@@ -273,6 +685,36 @@ ret:
     return rc;
 }
 
+/* see sec-lsm-manager-server.h */
+__wur __nonnull()
+int sec_lsm_manager_server_set_workers(sec_lsm_manager_server_t *server, unsigned count)
+{
+    int rc;
+
+    if (server->workers != NULL)
+        return -EEXIST;
+    if (count == 0)
+        return 0;
+
+    rc = worker_pool_create(&server->workers, count);
+    if (rc < 0) {
+        ERROR("can't create workers: %d %s", -rc, strerror(-rc));
+        return rc;
+    }
+
+    server->workers_pollitem.handler = on_workers_event;
+    server->workers_pollitem.closure = server;
+    server->workers_pollitem.fd = worker_pool_fd(server->workers);
+    rc = pollitem_add(&server->workers_pollitem, EPOLLIN, server->pollfd);
+    if (rc < 0) {
+        rc = -errno;
+        ERROR("can't poll workers: %d %s", -rc, strerror(-rc));
+        worker_pool_destroy(server->workers);
+        server->workers = NULL;
+    }
+    return rc;
+}
+
 /* see sec-lsm-manager-server.h */
 void sec_lsm_manager_server_stop(sec_lsm_manager_server_t *server, int status) {
     if (!server->stopped) {
@@ -287,38 +729,20 @@ __wur int sec_lsm_manager_server_serve(sec_lsm_manager_server_t *server, int shu
     /* process inputs */
     server->stoprc = 0;
     server->stopped = false;
+    server->shutofftime = shutofftime;
     while (!server->stopped) {
-        int rc = pollitem_wait_dispatch(server->pollfd, tempo);
+        int rc;
+        update_timer(server);
+        server->now_valid = false;
+        rc = pollitem_wait_dispatch(server->pollfd, tempo);
         if (rc < 0 && errno != EINTR) {
             ERROR("when dispatching %d: %s", errno, strerror(errno));
             sec_lsm_manager_server_stop(server, rc);
         }
         else {
-            time_t trig = shutofftime < 0 ? 0 : time(NULL) - shutofftime;
-            int idx, ncli;
-            for (idx = ncli = 0 ; idx < MAX_CLIENT_COUNT ; idx ++) {
-                struct client *client = &server->clients[idx];
-                if (client->client != NULL) {
-                    if (client->lasttime <= trig)
-                        client_disconnect(client->client);
-                    if (client_is_connected(client->client))
-                        ncli++;
-                    else {
-                        pollitem_del(&client->pollitem, server->pollfd);
-                        client_destroy(client->client);
-                        client->client = NULL;
-                    }
-                }
-            }
-            if (rc == 0 && ncli == 0 && shutofftime >= 0)
+            recycle_released_slots(server);
+            if (rc == 0 && server->nr_clients == 0 && shutofftime >= 0)
                 sec_lsm_manager_server_stop(server, 0);
-            else if (server->deaf && ncli < MAX_CLIENT_COUNT) {
-                rc = pollitem_mod(&server->pollitem, EPOLLIN, server->pollfd);
-                if (rc < 0) {
-                    ERROR("unexpected server socket error");
-                    sec_lsm_manager_server_stop(server, rc);
-                }
-            }
         }
     }
     return server->stoprc;
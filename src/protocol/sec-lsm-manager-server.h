@@ -35,11 +35,19 @@ typedef struct sec_lsm_manager_server sec_lsm_manager_server_t;
  */
 extern bool sec_lsm_manager_server_log;
 
+/**
+ * @brief Boolean flag telling whether the server polls its clients
+ * in edge triggered mode or not (level triggered is the default)
+ */
+extern bool sec_lsm_manager_server_edge_triggered;
+
 /**
  * @brief Create a security manager server
  *
  * @param[out] server where to store the handler of the created server
  * @param[in] socket_spec specification of socket
+ * @param[in] max_clients maximum count of simultaneous clients,
+ *                        also used as listen backlog (0 means default)
  *
  * @return 0 on success or a negative value
  *
@@ -47,7 +55,21 @@ extern bool sec_lsm_manager_server_log;
  */
 __wur __nonnull((1))
 extern int sec_lsm_manager_server_create(sec_lsm_manager_server_t **server,
-                                         const char *sec_lsm_manager_socket_spec);
+                                         const char *sec_lsm_manager_socket_spec,
+                                         unsigned max_clients);
+
+/**
+ * @brief Set the count of worker threads running the actions install
+ * and uninstall. Without workers, the default, actions are run by the
+ * thread serving. Can be called only once.
+ *
+ * @param[in] server the handler of the server
+ * @param[in] count the count of worker threads (0 means no workers)
+ *
+ * @return 0 on success or a negative value
+ */
+__wur __nonnull()
+extern int sec_lsm_manager_server_set_workers(sec_lsm_manager_server_t *server, unsigned count);
 
 /**
  * @brief Destroy a created server and release its resources
@@ -27,12 +27,15 @@
 #include "sec-lsm-manager.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <poll.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "prot.h"
@@ -86,6 +89,48 @@ struct sec_lsm_manager
 
     /** spec of the socket */
     char *socketspec;
+
+    /** state of the current batch */
+    struct {
+        /** is a batch started? */
+        bool active;
+
+        /** count of requests sent */
+        unsigned sent;
+
+        /** count of replies received */
+        unsigned received;
+
+        /** count of error replies received */
+        unsigned failed;
+
+        /** sticky error of the link */
+        int rc;
+
+        /** callback of error replies */
+        void (*onerror)(void *closure, unsigned index, int count, const char *fields[]);
+
+        /** closure of the callback */
+        void *closure;
+    } batch;
+
+    /** state of the current manifest */
+    struct {
+        /** is a manifest started? */
+        bool active;
+
+        /** sticky error of the composition */
+        int rc;
+
+        /** length of the data */
+        size_t length;
+
+        /** allocated size of the data */
+        size_t size;
+
+        /** the data of the manifest */
+        char *data;
+    } manifest;
 };
 
 /**
@@ -160,14 +205,20 @@ __nonnull() __wur
 static int send_fields(sec_lsm_manager_t *sec_lsm_manager, const char **fields, int count) {
     int rc, trial, i;
     prot_t *prot;
+    const char *first;
 
     /* retrieves the protocol handler */
     prot = sec_lsm_manager->prot;
+
+    /* version 2 transmits the opcode instead of the name */
+    first = count <= 0 || !prot_is_binary(prot) ? NULL
+          : sec_lsm_manager_opcode_code(sec_lsm_manager_opcode_of_name(fields[0]));
+
     trial = 0;
     for (;;) {
         /* fill the fields */
         for (i = rc = 0; i < count && rc == 0; i++)
-	    rc = prot_put_field(prot, fields[i]);
+	    rc = prot_put_field(prot, i == 0 && first != NULL ? first : fields[i]);
 
         /* send if done */
         if (rc == 0) {
@@ -251,6 +302,28 @@ static int wait_input(sec_lsm_manager_t *sec_lsm_manager) {
     return rc < 0 ? -errno : 0;
 }
 
+/**
+ * @brief Record the reply just got, restoring its name in version 2
+ *
+ * @param[in] sec_lsm_manager  the handler of the client
+ * @param[in] count the count of fields of the reply
+ *
+ * @return  the count of fields or -EPROTO if the reply is not valid
+ */
+__nonnull() __wur
+static int got_reply(sec_lsm_manager_t *sec_lsm_manager, int count) {
+    const char *name;
+
+    if (prot_is_binary(sec_lsm_manager->prot)) {
+        name = sec_lsm_manager_opcode_name(sec_lsm_manager_opcode_of_code(sec_lsm_manager->reply.fields[0]));
+        if (name == NULL)
+            return -EPROTO;
+        sec_lsm_manager->reply.fields[0] = name;
+    }
+    sec_lsm_manager->reply.count = count;
+    return count;
+}
+
 /**
  * @brief Wait for a reply
  *
@@ -269,12 +342,13 @@ static int wait_reply(sec_lsm_manager_t *sec_lsm_manager, bool block) {
         prot_next(sec_lsm_manager->prot);
         rc = prot_get(sec_lsm_manager->prot, &sec_lsm_manager->reply.fields);
         if (rc > 0) {
-            sec_lsm_manager->reply.count = rc;
-            return rc;
+            rc = got_reply(sec_lsm_manager, rc);
+            if (rc > 0)
+                return rc;
         }
 
-        if (rc == -EMSGSIZE) {
-            /* the input is too big */
+        if (rc == -EMSGSIZE || rc == -EBADMSG || rc == -EPROTO) {
+            /* the input is too big or invalid */
 disconnect:
             disconnection(sec_lsm_manager, state_Broken);
             errno = EPIPE;
@@ -372,14 +446,18 @@ static int connection(sec_lsm_manager_t *sec_lsm_manager) {
     if (sec_lsm_manager->fd < 0)
         return -errno;
 
-    /* negociate the protocol */
-    rc = putxkv(sec_lsm_manager, _sec_lsm_manager_, "1", NULL);
+    /* negociate the protocol, the server selects the last version it knows */
+    rc = putxkv(sec_lsm_manager, _sec_lsm_manager_, "1", "2", NULL);
     if (rc >= 0) {
         rc = wait_any_reply(sec_lsm_manager);
         if (rc >= 0) {
             if (sec_lsm_manager->reply.count >= 2
              && 0 == strcmp(sec_lsm_manager->reply.fields[0], _done_)
-             && 0 == strcmp(sec_lsm_manager->reply.fields[1], "1")) {
+             && (0 == strcmp(sec_lsm_manager->reply.fields[1], "1")
+              || 0 == strcmp(sec_lsm_manager->reply.fields[1], "2"))) {
+                /* version 2 uses binary framing after the hand-shake */
+                prot_set_binary(sec_lsm_manager->prot,
+                                0 == strcmp(sec_lsm_manager->reply.fields[1], "2"));
                 sec_lsm_manager->state = state_Connected;
                 return 0;
             }
@@ -446,6 +524,195 @@ static int sync_process(
     return rc;
 }
 
+/**
+ * @brief Process the replies of the batch already received
+ *
+ * @param[in] sec_lsm_manager  the handler of the client
+ *
+ * @return  0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int batch_replies(sec_lsm_manager_t *sec_lsm_manager) {
+    int rc;
+
+    for (;;) {
+        prot_next(sec_lsm_manager->prot);
+        rc = prot_get(sec_lsm_manager->prot, &sec_lsm_manager->reply.fields);
+        if (rc == -EAGAIN)
+            return 0;
+        if (rc <= 0 || sec_lsm_manager->batch.received == sec_lsm_manager->batch.sent)
+            return -EPROTO;
+        rc = got_reply(sec_lsm_manager, rc);
+        if (rc < 0)
+            return rc;
+        if (!strcmp(sec_lsm_manager->reply.fields[0], _error_)) {
+            sec_lsm_manager->batch.failed++;
+            if (sec_lsm_manager->batch.onerror != NULL)
+                sec_lsm_manager->batch.onerror(sec_lsm_manager->batch.closure,
+                                               sec_lsm_manager->batch.received,
+                                               rc - 1, &sec_lsm_manager->reply.fields[1]);
+        }
+        else if (strcmp(sec_lsm_manager->reply.fields[0], _done_))
+            return -EPROTO;
+        sec_lsm_manager->batch.received++;
+    }
+}
+
+/**
+ * @brief Write the requests of the batch while reading its replies,
+ * so that the server never blocks on its output
+ *
+ * @param[in] sec_lsm_manager  the handler of the client
+ * @param[in] all wait all the replies if true or only the write otherwise
+ *
+ * @return  0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int batch_pump(sec_lsm_manager_t *sec_lsm_manager, bool all) {
+    int rc;
+    struct pollfd pfd;
+
+    rc = sec_lsm_manager->batch.rc;
+    while (rc >= 0) {
+        /* process the received replies */
+        rc = batch_replies(sec_lsm_manager);
+        if (rc < 0)
+            break;
+
+        /* write the requests */
+        while (prot_should_write(sec_lsm_manager->prot)) {
+            rc = prot_write(sec_lsm_manager->prot, sec_lsm_manager->fd);
+            if (rc < 0)
+                break;
+        }
+        if (rc < 0 && rc != -EAGAIN)
+            break;
+
+        /* check completion */
+        if (!prot_should_write(sec_lsm_manager->prot)
+         && (!all || sec_lsm_manager->batch.received == sec_lsm_manager->batch.sent))
+            return 0;
+
+        /* read the replies */
+        rc = prot_read(sec_lsm_manager->prot, sec_lsm_manager->fd);
+        if (rc == 0)
+            rc = -EPIPE;
+        else if (rc == -EAGAIN) {
+            pfd.fd = sec_lsm_manager->fd;
+            pfd.events = prot_should_write(sec_lsm_manager->prot) ? POLLIN | POLLOUT : POLLIN;
+            do {
+                rc = poll(&pfd, 1, -1);
+            } while (rc < 0 && errno == EINTR);
+            if (rc < 0)
+                rc = -errno;
+        }
+    }
+
+    /* the link is no more in sync */
+    disconnection(sec_lsm_manager, state_Broken);
+    sec_lsm_manager->batch.rc = rc;
+    return rc;
+}
+
+/**
+ * @brief Add a request to the current batch, its reply is processed later
+ *
+ * @param[in] sec_lsm_manager  the handler of the client
+ * @param[in] nfields count of fields of the request
+ * @param[in] fields the fields of the request
+ *
+ * @return  0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int batch_put(sec_lsm_manager_t *sec_lsm_manager, int nfields, const char *fields[]) {
+    int rc;
+
+    /* version 2 transmits the opcode instead of the name */
+    if (prot_is_binary(sec_lsm_manager->prot))
+        fields[0] = sec_lsm_manager_opcode_code(sec_lsm_manager_opcode_of_name(fields[0]));
+
+    rc = sec_lsm_manager->batch.rc;
+    if (rc >= 0) {
+        rc = prot_put(sec_lsm_manager->prot, (unsigned)nfields, fields);
+        if (rc == -ECANCELED) {
+            /* output buffer full, send it */
+            rc = batch_pump(sec_lsm_manager, false);
+            if (rc >= 0)
+                rc = prot_put(sec_lsm_manager->prot, (unsigned)nfields, fields);
+        }
+        if (rc >= 0)
+            sec_lsm_manager->batch.sent++;
+    }
+    return rc;
+}
+
+/**
+ * @brief Append the entry of a request to the current manifest.
+ * The request clear restarts the manifest.
+ *
+ * @param[in] sec_lsm_manager  the handler of the client
+ * @param[in] nfields count of fields of the request
+ * @param[in] fields the fields of the request
+ *
+ * @return  0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int manifest_put(sec_lsm_manager_t *sec_lsm_manager, int nfields, const char *fields[]) {
+    static const char *header[] = { _sec_lsm_manager_manifest_, SEC_LSM_MANAGER_MANIFEST_VERSION };
+    size_t length, size, lengths[8];
+    unsigned opcode;
+    char *data;
+    int i;
+
+    if (sec_lsm_manager->manifest.rc < 0)
+        return sec_lsm_manager->manifest.rc;
+
+    /* the header or the opcode of the entry then the arguments */
+    opcode = sec_lsm_manager_opcode_of_name(fields[0]);
+    if (opcode == opcode_clear) {
+        sec_lsm_manager->manifest.length = 0;
+        fields = header;
+        nfields = 2;
+    }
+    else
+        fields[0] = sec_lsm_manager_opcode_code(opcode);
+
+    /* ensure room */
+    length = sec_lsm_manager->manifest.length;
+    for (i = 0 ; i < nfields ; i++)
+        length += (lengths[i] = strlen(fields[i]) + 1);
+    if (length > sec_lsm_manager->manifest.size) {
+        size = sec_lsm_manager->manifest.size ? sec_lsm_manager->manifest.size : 4096;
+        while (size < length)
+            size <<= 1;
+        data = realloc(sec_lsm_manager->manifest.data, size);
+        if (data == NULL)
+            return sec_lsm_manager->manifest.rc = -ENOMEM;
+        sec_lsm_manager->manifest.data = data;
+        sec_lsm_manager->manifest.size = size;
+    }
+
+    /* append the fields with their terminating zero */
+    data = &sec_lsm_manager->manifest.data[sec_lsm_manager->manifest.length];
+    for (i = 0 ; i < nfields ; data += lengths[i++])
+        memcpy(data, fields[i], lengths[i]);
+    sec_lsm_manager->manifest.length = length;
+    return 0;
+}
+
+/**
+ * @brief Process a request replying done or error,
+ * either synchronously, in the current batch or in the current manifest
+ */
+__nonnull() __wur
+static int process_simple(sec_lsm_manager_t *sec_lsm_manager, int nfields, const char *fields[]) {
+    if (sec_lsm_manager->manifest.active)
+        return manifest_put(sec_lsm_manager, nfields, fields);
+    if (sec_lsm_manager->batch.active)
+        return batch_put(sec_lsm_manager, nfields, fields);
+    return sync_process(sec_lsm_manager, nfields, fields, wait_done_or_error, NULL);
+}
+
 /**********************/
 /*** PUBLIC METHODS ***/
 /**********************/
@@ -506,6 +773,7 @@ void sec_lsm_manager_destroy(sec_lsm_manager_t *sec_lsm_manager) {
         disconnection(sec_lsm_manager, state_Broken);
         if (sec_lsm_manager->prot)
             prot_destroy(sec_lsm_manager->prot);
+        free(sec_lsm_manager->manifest.data);
         free(sec_lsm_manager->socketspec);
         free(sec_lsm_manager);
     }
@@ -526,8 +794,7 @@ int sec_lsm_manager_set_id(sec_lsm_manager_t *sec_lsm_manager, const char *id) {
     if (sec_lsm_manager == NULL || id == NULL)
         return -EINVAL;
 
-    return sync_process(sec_lsm_manager, 2, (const char*[]){ _id_, id },
-                        wait_done_or_error, NULL);
+    return process_simple(sec_lsm_manager, 2, (const char*[]){ _id_, id });
 }
 
 /* see sec-lsm-manager.h */
@@ -537,8 +804,7 @@ int sec_lsm_manager_add_path(sec_lsm_manager_t *sec_lsm_manager, const char *pat
     if (sec_lsm_manager == NULL || path == NULL || path_type == NULL)
         return -EINVAL;
 
-    return sync_process(sec_lsm_manager, 3, (const char*[]){ _path_, path, path_type },
-                        wait_done_or_error, NULL);
+    return process_simple(sec_lsm_manager, 3, (const char*[]){ _path_, path, path_type });
 }
 
 /* see sec-lsm-manager.h */
@@ -549,8 +815,7 @@ int sec_lsm_manager_add_plug(sec_lsm_manager_t *sec_lsm_manager, const char *exp
     if (sec_lsm_manager == NULL || expdir == NULL || impid == NULL || impdir == NULL)
         return -EINVAL;
 
-    return sync_process(sec_lsm_manager, 4, (const char*[]){ _plug_, expdir, impid, impdir },
-                        wait_done_or_error, NULL);
+    return process_simple(sec_lsm_manager, 4, (const char*[]){ _plug_, expdir, impid, impdir });
 }
 
 /* see sec-lsm-manager.h */
@@ -560,8 +825,7 @@ int sec_lsm_manager_add_permission(sec_lsm_manager_t *sec_lsm_manager, const cha
     if (sec_lsm_manager == NULL || permission == NULL)
         return -EINVAL;
 
-    return sync_process(sec_lsm_manager, 2, (const char*[]){ _permission_, permission },
-                        wait_done_or_error, NULL);
+    return process_simple(sec_lsm_manager, 2, (const char*[]){ _permission_, permission });
 }
 
 /* see sec-lsm-manager.h */
@@ -570,8 +834,7 @@ int sec_lsm_manager_clear(sec_lsm_manager_t *sec_lsm_manager) {
     /* check parameters not NULL */
     if (sec_lsm_manager == NULL)
         return -EINVAL;
-    return sync_process(sec_lsm_manager, 1, (const char*[]){ _clear_ },
-                        wait_done_or_error, NULL);
+    return process_simple(sec_lsm_manager, 1, (const char*[]){ _clear_ });
 }
 
 /* see sec-lsm-manager.h */
@@ -594,6 +857,90 @@ int sec_lsm_manager_uninstall(sec_lsm_manager_t *sec_lsm_manager) {
                         wait_done_or_error, NULL);
 }
 
+/**
+ * @brief callback for processing replies of install async
+ * @param sec_lsm_manager sec_lsm_manager client handler
+ * @param closure pointer to the ticket to set
+ * @return 0 on success or a negative -errno value
+ */
+static int wait_ticket_reply(sec_lsm_manager_t *sec_lsm_manager, void *closure)
+{
+    unsigned *ticket = closure;
+    unsigned long value;
+    char *end;
+    int rc = raw_wait_done_or_error(sec_lsm_manager);
+    if (rc > 0) {
+        if (rc < 2)
+            return -EPROTO;
+        value = strtoul(sec_lsm_manager->reply.fields[1], &end, 10);
+        if (*end != '\0' || value == 0 || value > UINT_MAX)
+            return -EPROTO;
+        *ticket = (unsigned)value;
+        rc = 0;
+    }
+    return rc;
+}
+
+/* see sec-lsm-manager.h */
+__nonnull() __wur
+int sec_lsm_manager_install_async(sec_lsm_manager_t *sec_lsm_manager, unsigned *ticket) {
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL || ticket == NULL)
+        return -EINVAL;
+    return sync_process(sec_lsm_manager, 2, (const char*[]){ _install_, _async_ },
+                        wait_ticket_reply, ticket);
+}
+
+/* see sec-lsm-manager.h */
+__nonnull() __wur
+int sec_lsm_manager_wait(sec_lsm_manager_t *sec_lsm_manager, unsigned ticket) {
+    char text[20];
+
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL)
+        return -EINVAL;
+    snprintf(text, sizeof text, "%u", ticket);
+    return sync_process(sec_lsm_manager, 2, (const char*[]){ _wait_, text },
+                        wait_done_or_error, NULL);
+}
+
+/**
+ * @brief callback for processing status replies
+ * @param sec_lsm_manager sec_lsm_manager client handler
+ * @return the status of the ticket or a negative -errno value
+ */
+static int wait_status_reply(sec_lsm_manager_t *sec_lsm_manager, void *closure)
+{
+    (void)closure;
+    int rc = raw_wait_done_or_error(sec_lsm_manager);
+    if (rc > 0) {
+        if (rc < 2)
+            rc = -EPROTO;
+        else if (!strcmp(sec_lsm_manager->reply.fields[1], _pending_))
+            rc = SEC_LSM_MANAGER_TICKET_PENDING;
+        else if (!strcmp(sec_lsm_manager->reply.fields[1], _installed_))
+            rc = SEC_LSM_MANAGER_TICKET_INSTALLED;
+        else if (!strcmp(sec_lsm_manager->reply.fields[1], _failed_))
+            rc = SEC_LSM_MANAGER_TICKET_FAILED;
+        else
+            rc = -EPROTO;
+    }
+    return rc;
+}
+
+/* see sec-lsm-manager.h */
+__nonnull() __wur
+int sec_lsm_manager_status(sec_lsm_manager_t *sec_lsm_manager, unsigned ticket) {
+    char text[20];
+
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL)
+        return -EINVAL;
+    snprintf(text, sizeof text, "%u", ticket);
+    return sync_process(sec_lsm_manager, 2, (const char*[]){ _status_, text },
+                        wait_status_reply, NULL);
+}
+
 /**
  * @brief callback for processing log replies
  * @param sec_lsm_manager sec_lsm_manager client handler
@@ -661,6 +1008,157 @@ int sec_lsm_manager_display(
                         wait_display_replies, &data);
 }
 
+/* see sec-lsm-manager.h */
+__nonnull((1)) __wur
+int sec_lsm_manager_batch_begin(
+        sec_lsm_manager_t *sec_lsm_manager,
+        void (*onerror)(void *closure, unsigned index, int count, const char *fields[]),
+        void *closure
+) {
+    int rc;
+
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL)
+        return -EINVAL;
+
+    /* check lock */
+    if (sec_lsm_manager->synclock || sec_lsm_manager->manifest.active)
+        return -EBUSY;
+
+    /* open and lock until commit */
+    rc = ensure_opened(sec_lsm_manager);
+    if (rc >= 0) {
+        sec_lsm_manager->synclock = true;
+        sec_lsm_manager->batch.active = true;
+        sec_lsm_manager->batch.sent = 0;
+        sec_lsm_manager->batch.received = 0;
+        sec_lsm_manager->batch.failed = 0;
+        sec_lsm_manager->batch.rc = 0;
+        sec_lsm_manager->batch.onerror = onerror;
+        sec_lsm_manager->batch.closure = closure;
+    }
+    return rc;
+}
+
+/* see sec-lsm-manager.h */
+__nonnull() __wur
+int sec_lsm_manager_batch_commit(sec_lsm_manager_t *sec_lsm_manager) {
+    int rc;
+
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL)
+        return -EINVAL;
+
+    /* check state */
+    if (!sec_lsm_manager->batch.active)
+        return -EINVAL;
+
+    /* send all and get all replies */
+    rc = batch_pump(sec_lsm_manager, true);
+    sec_lsm_manager->batch.active = false;
+    sec_lsm_manager->synclock = false;
+    return rc < 0 ? rc : (int)sec_lsm_manager->batch.failed;
+}
+
+/* see sec-lsm-manager.h */
+__nonnull() __wur
+int sec_lsm_manager_manifest(sec_lsm_manager_t *sec_lsm_manager, int fd) {
+    int rc;
+
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL || fd < 0)
+        return -EINVAL;
+
+    /* check lock */
+    if (sec_lsm_manager->synclock)
+        return -EBUSY;
+
+    /* lock and open */
+    sec_lsm_manager->synclock = true;
+    rc = ensure_opened(sec_lsm_manager);
+    if (rc >= 0) {
+        /* the file is passed with the request */
+        rc = prot_put_fd(sec_lsm_manager->prot, fd);
+        if (rc >= 0) {
+            rc = send_fields(sec_lsm_manager, (const char*[]){ _manifest_ }, 1);
+            if (rc >= 0) {
+                rc = raw_wait_done_or_error(sec_lsm_manager);
+                if (rc > 0)
+                    rc = 0;
+            }
+        }
+    }
+    sec_lsm_manager->synclock = false;
+    return rc;
+}
+
+/* see sec-lsm-manager.h */
+__nonnull() __wur
+int sec_lsm_manager_manifest_begin(sec_lsm_manager_t *sec_lsm_manager) {
+    int rc;
+
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL)
+        return -EINVAL;
+
+    /* check state */
+    if (sec_lsm_manager->synclock || sec_lsm_manager->manifest.active)
+        return -EBUSY;
+
+    /* start with the header and lock until commit */
+    sec_lsm_manager->manifest.rc = 0;
+    rc = manifest_put(sec_lsm_manager, 1, (const char*[]){ _clear_ });
+    if (rc >= 0) {
+        sec_lsm_manager->synclock = true;
+        sec_lsm_manager->manifest.active = true;
+    }
+    return rc;
+}
+
+/* see sec-lsm-manager.h */
+__nonnull() __wur
+int sec_lsm_manager_manifest_commit(sec_lsm_manager_t *sec_lsm_manager) {
+    int rc, fd;
+    ssize_t szr;
+    size_t done;
+
+    /* check parameters not NULL */
+    if (sec_lsm_manager == NULL)
+        return -EINVAL;
+
+    /* check state */
+    if (!sec_lsm_manager->manifest.active)
+        return -EINVAL;
+    sec_lsm_manager->manifest.active = false;
+    sec_lsm_manager->synclock = false;
+    rc = sec_lsm_manager->manifest.rc;
+    if (rc < 0)
+        return rc;
+
+    /* write the manifest in a sealed memory file */
+    fd = memfd_create(_sec_lsm_manager_manifest_, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        return -errno;
+    for (done = 0 ; done < sec_lsm_manager->manifest.length ; done += (size_t)szr) {
+        do {
+            szr = write(fd, &sec_lsm_manager->manifest.data[done],
+                        sec_lsm_manager->manifest.length - done);
+        } while (szr < 0 && errno == EINTR);
+        if (szr < 0) {
+            rc = -errno;
+            break;
+        }
+    }
+    if (rc >= 0 && fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)
+        rc = -errno;
+
+    /* send it */
+    if (rc >= 0)
+        rc = sec_lsm_manager_manifest(sec_lsm_manager, fd);
+    close(fd);
+    return rc;
+}
+
 /* see sec-lsm-manager.h */
 __nonnull() __wur
 int sec_lsm_manager_error_message(sec_lsm_manager_t *sec_lsm_manager, char **message)
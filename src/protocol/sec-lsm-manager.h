@@ -27,7 +27,7 @@
 #include <features.h>
 
 /** declare the version of the client API */
-#define SEC_LSM_MANAGER_CLIENT_API_VERSION 2
+#define SEC_LSM_MANAGER_CLIENT_API_VERSION 5
 
 /** the opaque structure for handling sec-lsm-manager */
 typedef struct sec_lsm_manager sec_lsm_manager_t;
@@ -146,6 +146,54 @@ extern int sec_lsm_manager_clear(sec_lsm_manager_t *sec_lsm_manager);
 __nonnull() __wur
 extern int sec_lsm_manager_install(sec_lsm_manager_t *sec_lsm_manager);
 
+/**
+ * @brief Start the install of an application with all defined parameters
+ * in the security manager handle (permissions, paths, plugs) without
+ * waiting its completion. On success, the handle is reset in the create
+ * state, allowing to define and install an other application.
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @param[out] ticket where to store the ticket of the install
+ * @return 0 in case of success or a negative -errno value
+ *
+ * @see sec_lsm_manager_wait
+ * @see sec_lsm_manager_status
+ */
+__nonnull() __wur
+extern int sec_lsm_manager_install_async(sec_lsm_manager_t *sec_lsm_manager, unsigned *ticket);
+
+/**
+ * @brief Wait the completion of the install of a ticket and release the ticket
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @param[in] ticket the ticket of the install
+ * @return 0 if the install succeeded or a negative -errno value
+ *
+ * @see sec_lsm_manager_install_async
+ */
+__nonnull() __wur
+extern int sec_lsm_manager_wait(sec_lsm_manager_t *sec_lsm_manager, unsigned ticket);
+
+/**
+ * status of tickets returned by sec_lsm_manager_status
+ */
+#define SEC_LSM_MANAGER_TICKET_PENDING    0
+#define SEC_LSM_MANAGER_TICKET_INSTALLED  1
+#define SEC_LSM_MANAGER_TICKET_FAILED     2
+
+/**
+ * @brief Get the status of the install of a ticket without waiting
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @param[in] ticket the ticket of the install
+ * @return the status SEC_LSM_MANAGER_TICKET_PENDING, SEC_LSM_MANAGER_TICKET_INSTALLED
+ *         or SEC_LSM_MANAGER_TICKET_FAILED or a negative -errno value
+ *
+ * @see sec_lsm_manager_install_async
+ */
+__nonnull() __wur
+extern int sec_lsm_manager_status(sec_lsm_manager_t *sec_lsm_manager, unsigned ticket);
+
 /**
  * @brief Uninstall an application (permissions, paths, plugs)
  *
@@ -181,6 +229,87 @@ extern int sec_lsm_manager_display(
 		void (*callback)(void *, int count, const char *[]),
 		void *closure);
 
+/**
+ * @brief Start a batch of requests. Until sec_lsm_manager_batch_commit,
+ * the requests made with sec_lsm_manager_set_id, sec_lsm_manager_add_path,
+ * sec_lsm_manager_add_plug, sec_lsm_manager_add_permission and
+ * sec_lsm_manager_clear are sent back to back without waiting their reply
+ * and return 0 unless the link is broken. Other requests return -EBUSY.
+ * Requests of the batch are indexed from 0 in the order of the calls.
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @param[in] onerror callback receiving the index of the failing requests
+ *                    and the fields of their error reply, can be NULL
+ * @param[in] closure closure for the callback
+ * @return 0 in case of success or a negative -errno value
+ *
+ * @see sec_lsm_manager_batch_commit
+ */
+__nonnull((1)) __wur
+extern int sec_lsm_manager_batch_begin(
+		sec_lsm_manager_t *sec_lsm_manager,
+		void (*onerror)(void *closure, unsigned index, int count, const char *fields[]),
+		void *closure);
+
+/**
+ * @brief Send the pending requests of the batch and wait all their replies.
+ * The callback given to sec_lsm_manager_batch_begin is called for each
+ * request that failed.
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @return the count of failed requests or a negative -errno value
+ *
+ * @see sec_lsm_manager_batch_begin
+ */
+__nonnull() __wur
+extern int sec_lsm_manager_batch_commit(sec_lsm_manager_t *sec_lsm_manager);
+
+/**
+ * @brief Replace the state of the security manager handle by the one
+ * described in the manifest file fd. The file is passed to the server
+ * that reads or maps it, so its content isn't copied through the socket.
+ * The server maps memory files sealed against writing and shrinking.
+ * The format of manifests is described in the protocol documentation.
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @param[in] fd the manifest file, not closed
+ * @return 0 in case of success or a negative -errno value
+ *
+ * @see sec_lsm_manager_manifest_begin
+ */
+__nonnull() __wur
+extern int sec_lsm_manager_manifest(sec_lsm_manager_t *sec_lsm_manager, int fd);
+
+/**
+ * @brief Start the composition of a manifest. Until
+ * sec_lsm_manager_manifest_commit, the requests made with
+ * sec_lsm_manager_set_id, sec_lsm_manager_add_path,
+ * sec_lsm_manager_add_plug and sec_lsm_manager_add_permission
+ * are recorded in the manifest instead of being sent and
+ * sec_lsm_manager_clear restarts the manifest. Other requests
+ * fail with -EBUSY until the commit.
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @return 0 in case of success or a negative -errno value
+ *
+ * @see sec_lsm_manager_manifest_commit
+ */
+__nonnull() __wur
+extern int sec_lsm_manager_manifest_begin(sec_lsm_manager_t *sec_lsm_manager);
+
+/**
+ * @brief Send the manifest composed since sec_lsm_manager_manifest_begin
+ * in a sealed memory file, replacing the state of the security manager
+ * handle in one request.
+ *
+ * @param[in] sec_lsm_manager sec_lsm_manager client handler
+ * @return 0 in case of success or a negative -errno value
+ *
+ * @see sec_lsm_manager_manifest_begin
+ */
+__nonnull() __wur
+extern int sec_lsm_manager_manifest_commit(sec_lsm_manager_t *sec_lsm_manager);
+
 /**
  * @brief Get copy of the lastest error message. The returned message
  *        must be freed using free.
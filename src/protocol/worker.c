@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "worker.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "log.h"
+
+/** structure for queues of jobs */
+typedef struct {
+    /** first job of the queue */
+    worker_job_t *head;
+
+    /** last job of the queue */
+    worker_job_t *tail;
+} job_queue_t;
+
+/** structure of pools of worker threads */
+struct worker_pool {
+    /** the mutex protecting the queues */
+    pthread_mutex_t mutex;
+
+    /** condition signaling pending jobs or stop */
+    pthread_cond_t cond;
+
+    /** jobs waiting a worker */
+    job_queue_t pending;
+
+    /** jobs processed, waiting completion */
+    job_queue_t processed;
+
+    /** eventfd signaling processed jobs */
+    int efd;
+
+    /** stopping request */
+    bool stopping;
+
+    /** count of threads */
+    unsigned count;
+
+    /** the threads */
+    pthread_t threads[];
+};
+
+/**
+ * @brief Add a job at the end of a queue
+ *
+ * @param[in] queue the queue
+ * @param[in] job the job to add
+ */
+__nonnull()
+static void queue_push(job_queue_t *queue, worker_job_t *job)
+{
+    job->next = NULL;
+    if (queue->tail == NULL)
+        queue->head = job;
+    else
+        queue->tail->next = job;
+    queue->tail = job;
+}
+
+/**
+ * @brief Remove the first job of a queue
+ *
+ * @param[in] queue the queue
+ * @return the removed job or NULL if the queue is empty
+ */
+__nonnull() __wur
+static worker_job_t *queue_pop(job_queue_t *queue)
+{
+    worker_job_t *job = queue->head;
+    if (job != NULL) {
+        queue->head = job->next;
+        if (queue->head == NULL)
+            queue->tail = NULL;
+    }
+    return job;
+}
+
+/**
+ * @brief Main routine of worker threads
+ *
+ * @param[in] arg the pool
+ * @return NULL
+ */
+static void *worker_main(void *arg)
+{
+    worker_pool_t *pool = arg;
+    worker_job_t *job;
+    uint64_t one = 1;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        job = queue_pop(&pool->pending);
+        if (job == NULL) {
+            if (pool->stopping)
+                break;
+            pthread_cond_wait(&pool->cond, &pool->mutex);
+        }
+        else {
+            pthread_mutex_unlock(&pool->mutex);
+            job->process(job);
+            pthread_mutex_lock(&pool->mutex);
+            queue_push(&pool->processed, job);
+            if (write(pool->efd, &one, sizeof one) < 0)
+                ERROR("can't signal processed job: %s", strerror(errno));
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**********************/
+/*** PUBLIC METHODS ***/
+/**********************/
+
+/* see worker.h */
+__wur __nonnull()
+int worker_pool_create(worker_pool_t **pool, unsigned count)
+{
+    worker_pool_t *p;
+    int rc;
+
+    /* allocation */
+    *pool = NULL;
+    if (count == 0)
+        return -EINVAL;
+    p = calloc(1, sizeof *p + count * sizeof *p->threads);
+    if (p == NULL)
+        return -ENOMEM;
+
+    /* initialisation */
+    p->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (p->efd < 0) {
+        rc = -errno;
+        free(p);
+        return rc;
+    }
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->cond, NULL);
+
+    /* start the threads */
+    for (p->count = 0 ; p->count < count ; p->count++) {
+        rc = pthread_create(&p->threads[p->count], NULL, worker_main, p);
+        if (rc != 0) {
+            ERROR("can't create worker thread: %s", strerror(rc));
+            worker_pool_destroy(p);
+            return -rc;
+        }
+    }
+    *pool = p;
+    return 0;
+}
+
+/* see worker.h */
+__nonnull()
+void worker_pool_destroy(worker_pool_t *pool)
+{
+    unsigned idx;
+
+    /* stop the threads after the processing of pending jobs */
+    pthread_mutex_lock(&pool->mutex);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+    for (idx = 0 ; idx < pool->count ; idx++)
+        pthread_join(pool->threads[idx], NULL);
+
+    /* complete the processed jobs */
+    worker_pool_dispatch(pool);
+
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->mutex);
+    close(pool->efd);
+    free(pool);
+}
+
+/* see worker.h */
+__wur __nonnull()
+int worker_pool_fd(worker_pool_t *pool)
+{
+    return pool->efd;
+}
+
+/* see worker.h */
+__nonnull()
+void worker_pool_post(worker_pool_t *pool, worker_job_t *job)
+{
+    pthread_mutex_lock(&pool->mutex);
+    queue_push(&pool->pending, job);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/* see worker.h */
+__nonnull()
+unsigned worker_pool_dispatch(worker_pool_t *pool)
+{
+    uint64_t count;
+    unsigned result = 0;
+    worker_job_t *job;
+
+    /* reset the event */
+    if (read(pool->efd, &count, sizeof count) < 0 && errno != EAGAIN)
+        ERROR("can't read processed job count: %s", strerror(errno));
+
+    /* complete the processed jobs */
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        job = queue_pop(&pool->processed);
+        pthread_mutex_unlock(&pool->mutex);
+        if (job == NULL)
+            return result;
+        job->completed(job);
+        result++;
+    }
+}
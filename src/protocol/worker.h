@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_WORKER_H
+#define SEC_LSM_MANAGER_WORKER_H
+
+/******************************************************************************/
+/******************************************************************************/
+/* IMPLEMENTATION OF A POOL OF WORKER THREADS                                 */
+/******************************************************************************/
+/******************************************************************************/
+
+#include <features.h>
+
+/** abstract pool of worker threads */
+typedef struct worker_pool worker_pool_t;
+
+/** structure for jobs processed by the workers */
+typedef struct worker_job worker_job_t;
+
+/**
+ * Structure for jobs processed by the workers
+ */
+struct worker_job {
+    /** callback processing the job in a worker thread */
+    void (*process)(worker_job_t *job);
+
+    /** callback called in the dispatching thread when the job is processed */
+    void (*completed)(worker_job_t *job);
+
+    /** link to the next job, private to the pool */
+    worker_job_t *next;
+};
+
+/**
+ * @brief Create a pool of worker threads
+ *
+ * @param[out] pool where to store the created pool
+ * @param[in] count count of threads of the pool (must not be 0)
+ * @return 0 on success or a negative -errno value
+ */
+__wur __nonnull()
+extern int worker_pool_create(worker_pool_t **pool, unsigned count);
+
+/**
+ * @brief Destroy the pool of worker threads. The jobs already posted
+ * are processed and completed before returning.
+ *
+ * @param[in] pool the pool to destroy
+ */
+__nonnull()
+extern void worker_pool_destroy(worker_pool_t *pool);
+
+/**
+ * @brief Get the file descriptor signaling availability of completed jobs.
+ * It has to be polled for reading and then worker_pool_dispatch called.
+ *
+ * @param[in] pool the pool
+ * @return the file descriptor (an eventfd)
+ */
+__wur __nonnull()
+extern int worker_pool_fd(worker_pool_t *pool);
+
+/**
+ * @brief Post a job to the pool. Its callback process will be called
+ * by a worker thread and then its callback completed will be called
+ * by worker_pool_dispatch. The jobs are started in their posting order.
+ *
+ * @param[in] pool the pool
+ * @param[in] job the job to post, it must be kept alive until completed
+ */
+__nonnull()
+extern void worker_pool_post(worker_pool_t *pool, worker_job_t *job);
+
+/**
+ * @brief Call the callback completed of the processed jobs
+ *
+ * @param[in] pool the pool
+ * @return the count of completed jobs
+ */
+__nonnull()
+extern unsigned worker_pool_dispatch(worker_pool_t *pool);
+
+#endif
@@ -23,16 +23,45 @@
 
 #include "smack.h"
 
-#include <stdint.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-static int ptr = 0;
+/** simulated handle, recording the rules added */
+struct smack_accesses {
+    char *rules;
+    size_t length;
+};
+
+/** the rules of the last application, see smack_simulation_applied */
+static char *applied = NULL;
+static pthread_mutex_t applied_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 #if !defined(SMACK_FS_PATH)
 #define SMACK_FS_PATH "/sys/fs/smackfs"
 #endif
 
+static int record_rule(struct smack_accesses *handle, const char *subject, const char *object,
+                       const char *access_type, const char *deny_access_type) {
+    char rule[4 * (SMACK_LABEL_LEN + 1) + 1];
+    size_t size;
+    char *rules;
+
+    if (deny_access_type == NULL)
+        snprintf(rule, sizeof rule, "%s %s %s\n", subject, object, access_type);
+    else
+        snprintf(rule, sizeof rule, "%s %s %s %s\n", subject, object, access_type, deny_access_type);
+    size = strlen(rule);
+    rules = realloc(handle->rules, handle->length + size + 1);
+    if (rules == NULL)
+        return -1;
+    memcpy(&rules[handle->length], rule, size + 1);
+    handle->rules = rules;
+    handle->length += size;
+    return 0;
+}
+
 ssize_t smack_label_length(const char *label) {
     fprintf(stderr, "smack_label_length(%s)\n", label);
     ssize_t len = (ssize_t)strlen(label);
@@ -49,18 +78,33 @@ const char *smack_smackfs_path(void) {
 
 int smack_accesses_new(struct smack_accesses **handle) {
     fprintf(stderr, "smack_accesses_new()\n");
-    *handle = (void *)(intptr_t)(++ptr);
-    return 0;
+    *handle = calloc(1, sizeof **handle);
+    return *handle == NULL ? -1 : 0;
 }
 
 int smack_accesses_add(struct smack_accesses *handle, const char *subject, const char *object,
                        const char *access_type) {
     fprintf(stderr, "smack_accesses_add(%p,%s,%s,%s)\n", (void *)handle, subject, object, access_type);
-    return 0;
+    return record_rule(handle, subject, object, access_type, NULL);
+}
+
+int smack_accesses_add_modify(struct smack_accesses *handle, const char *subject, const char *object,
+                              const char *allow_access_type, const char *deny_access_type) {
+    fprintf(stderr, "smack_accesses_add_modify(%p,%s,%s,%s,%s)\n", (void *)handle, subject, object,
+            allow_access_type, deny_access_type);
+    return record_rule(handle, subject, object, allow_access_type, deny_access_type);
 }
 
 int smack_accesses_apply(struct smack_accesses *handle) {
+    char *rules;
     fprintf(stderr, "smack_accesses_apply(%p)\n", (void *)handle);
+    rules = strdup(handle->rules != NULL ? handle->rules : "");
+    if (rules == NULL)
+        return -1;
+    pthread_mutex_lock(&applied_mutex);
+    free(applied);
+    applied = rules;
+    pthread_mutex_unlock(&applied_mutex);
     return 0;
 }
 
@@ -80,6 +124,18 @@ int smack_accesses_clear(struct smack_accesses *handle) {
 }
 
 void smack_accesses_free(struct smack_accesses *handle) {
-    fprintf(stderr, "smack_smackfs_path(%p)\n", (void *)handle);
+    fprintf(stderr, "smack_accesses_free(%p)\n", (void *)handle);
+    if (handle != NULL) {
+        free(handle->rules);
+        free(handle);
+    }
 }
 
+char *smack_simulation_applied(void) {
+    char *result;
+    pthread_mutex_lock(&applied_mutex);
+    result = applied != NULL ? applied : strdup("");
+    applied = NULL;
+    pthread_mutex_unlock(&applied_mutex);
+    return result;
+}
@@ -39,6 +39,9 @@ int smack_accesses_new(struct smack_accesses **handle);
 
 int smack_accesses_add(struct smack_accesses *handle, const char *subject, const char *object, const char *access_type);
 
+int smack_accesses_add_modify(struct smack_accesses *handle, const char *subject, const char *object,
+                              const char *allow_access_type, const char *deny_access_type);
+
 int smack_accesses_apply(struct smack_accesses *handle);
 
 int smack_accesses_save(struct smack_accesses *handle, int fd);
@@ -49,4 +52,13 @@ int smack_accesses_clear(struct smack_accesses *handle);
 
 void smack_accesses_free(struct smack_accesses *handle);
 
+/**
+ * @brief Simulation only: get the rules of the last smack_accesses_apply
+ * done since the previous call, one rule per line as given to
+ * smack_accesses_add and smack_accesses_add_modify
+ *
+ * @return the rules, empty if none, to be freed, or NULL when out of memory
+ */
+char *smack_simulation_applied(void);
+
 #endif
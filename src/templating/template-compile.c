@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "template-compile.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mustach.h"
+
+/***********************/
+/*** PRIVATE METHODS ***/
+/***********************/
+
+/**
+ * @brief Append an operation to the compiled template
+ *
+ * @param[inout] ops the operations
+ * @param[inout] count the count of operations
+ * @param[in] kind the kind of the operation
+ * @param[in] data the text or the name
+ * @param[in] length the length of the text
+ * @param[in] flag the flag
+ * @return the index of the operation or MUSTACH_ERROR_SYSTEM when out of memory
+ */
+__nonnull() __wur
+static int add_op(template_op_t **ops, size_t *count, enum template_op_kind kind,
+                  const char *data, size_t length, bool flag)
+{
+    template_op_t *op;
+
+    /* the operations are allocated by power of 2 */
+    if ((*count & (*count - 1)) == 0) {
+        op = realloc(*ops, (*count ? 2 * *count : 16) * sizeof *op);
+        if (op == NULL)
+            return MUSTACH_ERROR_SYSTEM;
+        *ops = op;
+    }
+    op = &(*ops)[*count];
+    op->kind = kind;
+    op->flag = flag;
+    op->link = 0;
+    op->length = length;
+    op->data = data;
+    op->bit = -1;
+    return (int)(*count)++;
+}
+
+/**********************/
+/*** PUBLIC METHODS ***/
+/**********************/
+
+/* see template-compile.h */
+__nonnull() __wur
+int template_compile(char *text, template_op_t **ops, size_t *count)
+{
+    char opstr[MUSTACH_MAX_LENGTH + 1] = "{{", clstr[MUSTACH_MAX_LENGTH + 1] = "}}";
+    size_t stack[MUSTACH_MAX_DEPTH];
+    size_t oplen = 2, cllen = 2, len, l;
+    char *template = text, *beg, *term, c;
+    int depth = 0, rc = MUSTACH_OK;
+
+    *ops = NULL;
+    *count = 0;
+    while (rc >= 0) {
+        beg = strstr(template, opstr);
+        if (beg == NULL) {
+            /* no more mustach */
+            if (template[0])
+                rc = add_op(ops, count, op_text, template, strlen(template), false);
+            if (rc >= 0)
+                rc = depth ? MUSTACH_ERROR_UNEXPECTED_END : MUSTACH_OK;
+            break;
+        }
+        if (beg != template) {
+            rc = add_op(ops, count, op_text, template, (size_t)(beg - template), false);
+            if (rc < 0)
+                break;
+        }
+        beg += oplen;
+        term = strstr(beg, clstr);
+        if (term == NULL) {
+            rc = MUSTACH_ERROR_UNEXPECTED_END;
+            break;
+        }
+        template = term + cllen;
+        len = (size_t)(term - beg);
+        c = *beg;
+
+        /* extract the name as fmustach does */
+        switch (c) {
+            case '!':
+            case '=':
+                break;
+            case '{':
+                for (l = 0; clstr[l] == '}'; l++);
+                if (clstr[l]) {
+                    if (!len || beg[len - 1] != '}')
+                        return MUSTACH_ERROR_BAD_UNESCAPE_TAG;
+                    len--;
+                } else {
+                    if (term[l] != '}')
+                        return MUSTACH_ERROR_BAD_UNESCAPE_TAG;
+                    template++;
+                }
+                c = '&';
+                /*@fallthrough@*/
+            case '^':
+            case '#':
+            case '/':
+            case '&':
+            case '>':
+            case ':':
+                beg++;
+                len--;
+                /*@fallthrough@*/
+            default:
+                while (len && isspace((unsigned char)beg[0])) {
+                    beg++;
+                    len--;
+                }
+                while (len && isspace((unsigned char)beg[len - 1]))
+                    len--;
+                if (len == 0)
+                    return MUSTACH_ERROR_EMPTY_TAG;
+                if (len > MUSTACH_MAX_LENGTH)
+                    return MUSTACH_ERROR_TAG_TOO_LONG;
+                break;
+        }
+
+        switch (c) {
+            case '!':
+                /* comment */
+                break;
+            case '=':
+                /* defines separators */
+                if (len < 5 || beg[len - 1] != '=')
+                    return MUSTACH_ERROR_BAD_SEPARATORS;
+                beg++;
+                len -= 2;
+                for (l = 0; l < len && !isspace((unsigned char)beg[l]); l++);
+                if (l == len)
+                    return MUSTACH_ERROR_BAD_SEPARATORS;
+                oplen = l;
+                memcpy(opstr, beg, oplen);
+                opstr[oplen] = '\0';
+                while (l < len && isspace((unsigned char)beg[l]))
+                    l++;
+                if (l == len)
+                    return MUSTACH_ERROR_BAD_SEPARATORS;
+                cllen = len - l;
+                memcpy(clstr, beg + l, cllen);
+                clstr[cllen] = '\0';
+                break;
+            case '^':
+            case '#':
+                /* begin section */
+                if (depth == MUSTACH_MAX_DEPTH)
+                    return MUSTACH_ERROR_TOO_DEEP;
+                beg[len] = '\0';
+                rc = add_op(ops, count, op_section, beg, 0, c == '^');
+                if (rc >= 0)
+                    stack[depth++] = (size_t)rc;
+                break;
+            case '/':
+                /* end section */
+                beg[len] = '\0';
+                if (depth == 0 || strcmp((*ops)[stack[depth - 1]].data, beg) != 0)
+                    return MUSTACH_ERROR_CLOSING;
+                rc = add_op(ops, count, op_end, beg, 0, false);
+                if (rc >= 0) {
+                    (*ops)[rc].link = stack[--depth];
+                    (*ops)[stack[depth]].link = (size_t)rc;
+                }
+                break;
+            case '>':
+                /* partials are let to fmustach */
+                return MUSTACH_ERROR_PARTIAL_NOT_FOUND;
+            default:
+                /* replacement */
+                beg[len] = '\0';
+                rc = add_op(ops, count, op_put, beg, 0, c != '&');
+                break;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#ifndef SEC_LSM_MANAGER_TEMPLATE_COMPILE_H
+#define SEC_LSM_MANAGER_TEMPLATE_COMPILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+/** kinds of operations of compiled templates */
+enum template_op_kind {
+    op_text,    /**< emit a text */
+    op_put,     /**< put a value */
+    op_section, /**< begin a section */
+    op_end      /**< end a section */
+};
+
+/**
+ * operation of a compiled template
+ */
+typedef struct {
+    /** kind of the operation */
+    enum template_op_kind kind;
+    /** escaping for op_put, inverted section for op_section */
+    bool flag;
+    /** for op_section, index of its end; for op_end, index of its section */
+    size_t link;
+    /** length of the text of op_text */
+    size_t length;
+    /** the text of op_text or the name of other operations */
+    const char *data;
+    /**
+     * for op_section checking a permission, the bit of the permission
+     * in contexts (see context_reference_permission) or -1 when unknown
+     */
+    int bit;
+} template_op_t;
+
+/**
+ * template compiled at build time, see template-gen.c
+ */
+typedef struct {
+    /** name of the template for messages */
+    const char *name;
+    /** the operations */
+    template_op_t *ops;
+    /** count of operations */
+    size_t count;
+} template_builtin_t;
+
+/**
+ * @brief Compile the template as fmustach would process it. The names
+ * are terminated in the text that must be kept with the operations.
+ *
+ * @param[in] text the text of the template, modified
+ * @param[out] ops the operations, to be freed even on error
+ * @param[out] count the count of operations
+ * @return MUSTACH_OK or a negative value when the template has to be
+ *         processed by fmustach (partials, errors)
+ */
+__nonnull() __wur
+extern int template_compile(char *text, template_op_t **ops, size_t *count);
+
+#endif /* SEC_LSM_MANAGER_TEMPLATE_COMPILE_H */
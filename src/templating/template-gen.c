@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+/*
+ * Generator of the C source of a template compiled at build time
+ *
+ * usage: template-gen TEMPLATE SYMBOL OUTPUT
+ *
+ * It writes in OUTPUT the definition of the template_builtin_t
+ * named SYMBOL, see template-compile.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "template-compile.h"
+
+/** names of the kinds of operations */
+static const char *kinds[] = {
+    [op_text] = "op_text",
+    [op_put] = "op_put",
+    [op_section] = "op_section",
+    [op_end] = "op_end"
+};
+
+/**
+ * @brief Read the whole file
+ *
+ * @param[in] path the path of the file
+ * @return the zero terminated content or NULL on error
+ */
+static char *read_all(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char *text = NULL, *ptr;
+    size_t length = 0, size = 0;
+
+    if (file == NULL)
+        return NULL;
+    for (;;) {
+        if (length == size) {
+            size = size ? 2 * size : 8192;
+            ptr = realloc(text, size + 1);
+            if (ptr == NULL)
+                break;
+            text = ptr;
+        }
+        length += fread(&text[length], 1, size - length, file);
+        if (length < size) {
+            if (ferror(file))
+                break;
+            fclose(file);
+            text[length] = '\0';
+            return text;
+        }
+    }
+    fclose(file);
+    free(text);
+    return NULL;
+}
+
+/**
+ * @brief Write the data as a C string literal, split at newlines
+ *
+ * @param[in] file the output
+ * @param[in] data the data
+ * @param[in] length the length of the data
+ */
+static void put_literal(FILE *file, const char *data, size_t length)
+{
+    unsigned char c;
+    size_t idx;
+
+    fputc('"', file);
+    for (idx = 0 ; idx < length ; idx++) {
+        c = (unsigned char)data[idx];
+        switch (c) {
+        case '\n':
+            fputs(idx + 1 < length ? "\\n\"\n              \"" : "\\n", file);
+            break;
+        case '\t':
+            fputs("\\t", file);
+            break;
+        case '"':
+        case '\\':
+            fprintf(file, "\\%c", c);
+            break;
+        case '?': /* avoid trigraphs */
+            fputs("\\?", file);
+            break;
+        default:
+            if (c < ' ' || c >= 127)
+                fprintf(file, "\\%03o", c);
+            else
+                fputc(c, file);
+            break;
+        }
+    }
+    fputc('"', file);
+}
+
+int main(int ac, char **av)
+{
+    template_op_t *ops = NULL;
+    size_t count = 0, idx;
+    const char *name;
+    char *text;
+    FILE *file;
+    int rc;
+
+    if (ac != 4) {
+        fprintf(stderr, "usage: %s TEMPLATE SYMBOL OUTPUT\n", av[0]);
+        return EXIT_FAILURE;
+    }
+
+    text = read_all(av[1]);
+    if (text == NULL) {
+        fprintf(stderr, "can't read %s\n", av[1]);
+        return EXIT_FAILURE;
+    }
+    rc = template_compile(text, &ops, &count);
+    if (rc < 0) {
+        fprintf(stderr, "can't compile %s: error %d (partials are not supported)\n", av[1], rc);
+        return EXIT_FAILURE;
+    }
+
+    file = fopen(av[3], "w");
+    if (file == NULL) {
+        fprintf(stderr, "can't create %s\n", av[3]);
+        return EXIT_FAILURE;
+    }
+    name = strrchr(av[1], '/');
+    name = name == NULL ? av[1] : name + 1;
+    fprintf(file, "/* generated by template-gen from %s, don't edit */\n\n", name);
+    fprintf(file, "#include \"templating/template-compile.h\"\n\n");
+    /* an empty template still needs one item */
+    fprintf(file, "static template_op_t ops[%zu] = {\n", count ? count : 1);
+    for (idx = 0 ; idx < count ; idx++) {
+        fprintf(file, "    { .kind = %s, .flag = %s, .link = %zu, .length = %zu, .bit = -1,\n",
+                kinds[ops[idx].kind], ops[idx].flag ? "true" : "false", ops[idx].link, ops[idx].length);
+        fputs("      .data = ", file);
+        put_literal(file, ops[idx].data,
+                    ops[idx].kind == op_text ? ops[idx].length : strlen(ops[idx].data));
+        fputs(" },\n", file);
+    }
+    fprintf(file, "};\n\n");
+    fprintf(file, "template_builtin_t %s = {\n", av[2]);
+    fprintf(file, "    .name = \"%s\",\n", name);
+    fprintf(file, "    .ops = ops,\n");
+    fprintf(file, "    .count = %zu\n", count);
+    fprintf(file, "};\n");
+
+    if (fclose(file) != 0) {
+        fprintf(stderr, "can't write %s\n", av[3]);
+        remove(av[3]);
+        return EXIT_FAILURE;
+    }
+    free(ops);
+    free(text);
+    return EXIT_SUCCESS;
+}
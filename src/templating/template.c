@@ -24,8 +24,11 @@
 #include "template.h"
 
 #include <stdbool.h>
+#include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +38,7 @@
 
 #include "log.h"
 #include "mustach.h"
+#include "template-compile.h"
 #include "file-utils.h"
 
 typedef struct {
@@ -43,20 +47,98 @@ typedef struct {
     }
         template_data_t;
 
-static int put(void *closure, const char *name, int escape, FILE *file) {
-    (void)escape;
-    template_data_t *data = closure;
-    bool underscore = name[0] == '_';
+#if !defined(TEMPLATE_MEMO_SIZE)
+#define TEMPLATE_MEMO_SIZE 64
+#endif
+
+/** maximum count of permission checks of memorized templates */
+#define TEMPLATE_MEMO_MAX_CHECKS 256
+
+/**
+ * place of the id in a rendered template
+ */
+typedef struct {
+    /** offset of the id in the text */
+    size_t offset;
+    /** true when dashes of the id are replaced by underscores */
+    bool underscore;
+} template_hole_t;
+
+/**
+ * buffer receiving the rendered template
+ */
+typedef struct {
+    /** the rendered text */
+    char *text;
+    /** length of the rendered text */
+    size_t length;
+    /** allocated size of the text */
+    size_t size;
+    /** when true, the id is not written but recorded in holes */
+    bool record;
+    /** the recorded places of the id */
+    template_hole_t *holes;
+    /** count of holes */
+    size_t nholes;
+} template_output_t;
+
+/** minimal allocated size of the output */
+#define TEMPLATE_OUTPUT_MIN_SIZE 4096
+
+/**
+ * memorized rendering of a compiled template, without the id
+ */
+typedef struct template_memo {
+    /** previous memo, more recently used */
+    struct template_memo *prev;
+    /** next memo, less recently used */
+    struct template_memo *next;
+    /** the compiled template */
+    const template_op_t *ops;
+    /** results of the permission checks of the template */
+    uint64_t signature[TEMPLATE_MEMO_MAX_CHECKS / 64];
+    /** the rendered text without the id */
+    char *text;
+    /** length of the text */
+    size_t length;
+    /** the places of the id in the text */
+    template_hole_t *holes;
+    /** count of holes */
+    size_t nholes;
+} template_memo_t;
+
+/** memorized renderings, from the most to the least recently used */
+static template_memo_t *memo_first = NULL, *memo_last = NULL;
+
+/** count of memorized renderings */
+static size_t memo_count = 0;
+
+/** counters of memorized renderings found or not */
+static unsigned long memo_hits = 0, memo_misses = 0;
+
+/** protection of the memorized renderings */
+static pthread_mutex_t memo_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Get the value of a name of the template
+ *
+ * @param[in] data the data of the template
+ * @param[in] name the name of the value
+ * @param[out] underscore true when dashes of the value must be replaced by underscores
+ * @return the value or NULL when the name has no value
+ */
+__nonnull() __wur
+static const char *value(const template_data_t *data, const char *name, bool *underscore) {
     const char *txt = NULL;
 
-    // DEBUG("name : %s", name);
+    *underscore = name[0] == '_';
 
     if (!strcmp(name, "id"))
         txt = data->context->id;
 
     else if (!strcmp(name, "id_underscore")) {
         txt = data->context->id;
-        underscore = true;
+        *underscore = true;
     }
 
     else if (!strcmp(name, "_id_"))
@@ -68,12 +150,30 @@ static int put(void *closure, const char *name, int escape, FILE *file) {
     else if (!strcmp(name, "_impid_") && data->plug != NULL)
         txt = data->plug->impid;
 
+    return txt;
+}
+
+static int put(void *closure, const char *name, int escape, FILE *file) {
+    (void)escape;
+    template_data_t *data = closure;
+    bool underscore;
+    const char *txt = value(data, name, &underscore);
+    size_t len;
+
+    // DEBUG("name : %s", name);
+
     if (txt != NULL) {
         if (!underscore)
             fputs(txt, file);
         else {
-            for ( ; *txt ; txt++)
-                fputc(*txt == '-' ? '_' : *txt, file);
+            for (;;) {
+                len = strcspn(txt, "-");
+                fwrite(txt, 1, len, file);
+                if (txt[len] == 0)
+                    break;
+                fputc('_', file);
+                txt += len + 1;
+            }
         }
     }
     return 0;
@@ -91,11 +191,11 @@ static int enter(void *closure, const char *name) {
         return 0;
 
     if (!strcmp(name, "has-plugs")) {
-        return data->context->plugset != NULL;
+        return data->context->plugset.first != NULL;
     }
 
     if (!strcmp(name, "plugs")) {
-        data->plug = data->context->plugset;
+        data->plug = data->context->plugset.first;
         return data->plug != NULL;
     }
 
@@ -119,36 +219,725 @@ static int next(void *closure) {
 
 static struct mustach_itf itf = {.enter = enter, .put = put, .next = next, .leave = leave};
 
-int template_process(const char *template_path, const char *dest, const context_t *context) {
+/***********************/
+/*** COMPILED FORM   ***/
+/***********************/
+
+/**
+ * cached template
+ */
+typedef struct template_entry {
+    /** next cached template */
+    struct template_entry *next;
+    /** count of references, the cache holds one */
+    unsigned refcount;
+    /** the status of the file when read, to detect changes */
+    struct stat stat;
+    /** the text of the template */
+    char *text;
+    /** the compiled template or NULL if it must be processed by fmustach */
+    template_op_t *ops;
+    /** count of operations */
+    size_t count;
+    /** path of the template */
+    char path[];
+} template_entry_t;
+
+/** the cached templates */
+static template_entry_t *cache = NULL;
+
+/** protection of the cache */
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Append text to the output
+ *
+ * @param[inout] output the output
+ * @param[in] text the text to append
+ * @param[in] length the length of the text
+ * @return MUSTACH_OK or MUSTACH_ERROR_SYSTEM when out of memory
+ */
+__nonnull() __wur
+static int output_append(template_output_t *output, const char *text, size_t length)
+{
+    size_t size = output->size ? output->size : TEMPLATE_OUTPUT_MIN_SIZE;
+    char *ptr;
+
+    if (length == 0)
+        return MUSTACH_OK;
+    if (output->length + length > output->size) {
+        while (output->length + length > size)
+            size *= 2;
+        ptr = realloc(output->text, size);
+        if (ptr == NULL) {
+            errno = ENOMEM;
+            return MUSTACH_ERROR_SYSTEM;
+        }
+        output->text = ptr;
+        output->size = size;
+    }
+    memcpy(&output->text[output->length], text, length);
+    output->length += length;
+    return MUSTACH_OK;
+}
+
+/**
+ * @brief Append a value to the output
+ *
+ * @param[inout] output the output
+ * @param[in] txt the value
+ * @param[in] underscore true when dashes are replaced by underscores
+ * @return MUSTACH_OK or MUSTACH_ERROR_SYSTEM when out of memory
+ */
+__nonnull() __wur
+static int output_value(template_output_t *output, const char *txt, bool underscore)
+{
+    size_t start = output->length;
+    char *iter;
+    int rc;
+
+    rc = output_append(output, txt, strlen(txt));
+    if (rc == MUSTACH_OK && underscore) {
+        for (iter = &output->text[start] ; iter != &output->text[output->length] ; iter++)
+            if (*iter == '-')
+                *iter = '_';
+    }
+    return rc;
+}
+
+/**
+ * @brief Record a place of the id in the output
+ *
+ * @param[inout] output the output
+ * @param[in] underscore true when dashes are replaced by underscores
+ * @return MUSTACH_OK or MUSTACH_ERROR_SYSTEM when out of memory
+ */
+__nonnull() __wur
+static int output_hole(template_output_t *output, bool underscore)
+{
+    template_hole_t *holes;
+
+    /* the holes are allocated by power of 2 */
+    if ((output->nholes & (output->nholes - 1)) == 0) {
+        holes = realloc(output->holes, (output->nholes ? 2 * output->nholes : 8) * sizeof *holes);
+        if (holes == NULL) {
+            errno = ENOMEM;
+            return MUSTACH_ERROR_SYSTEM;
+        }
+        output->holes = holes;
+    }
+    output->holes[output->nholes].offset = output->length;
+    output->holes[output->nholes++].underscore = underscore;
+    return MUSTACH_OK;
+}
+
+/**
+ * @brief Append the value of a name to the output, as put does
+ *
+ * @param[inout] output the output
+ * @param[in] data the data of the template
+ * @param[in] name the name of the value
+ * @return MUSTACH_OK or MUSTACH_ERROR_SYSTEM when out of memory
+ */
+__nonnull() __wur
+static int output_put(template_output_t *output, const template_data_t *data, const char *name)
+{
+    bool underscore;
+    const char *txt = value(data, name, &underscore);
+
+    if (txt == NULL)
+        return MUSTACH_OK;
+    if (output->record && txt == data->context->id)
+        return output_hole(output, underscore);
+    return output_value(output, txt, underscore);
+}
+
+/**
+ * @brief Check the condition of a section
+ *
+ * @param[in] op the operation of the section
+ * @param[in] data the data of the template
+ * @return the result of enter
+ */
+__nonnull() __wur
+static int check_section(const template_op_t *op, template_data_t *data)
+{
+    /* permissions with a bit are checked directly */
+    return op->bit >= 0 ? context_has_referenced_permission(data->context, op->bit)
+                        : enter(data, op->data);
+}
+
+/**
+ * @brief Render the compiled template as fmustach would do
+ *
+ * @param[in] ops the operations
+ * @param[in] count the count of operations
+ * @param[in] data the data of the template
+ * @param[inout] output the output receiving the rendered text
+ * @return MUSTACH_OK or a negative value on error
+ */
+__nonnull() __wur
+static int render(const template_op_t *ops, size_t count, template_data_t *data, template_output_t *output)
+{
+    int entered[MUSTACH_MAX_DEPTH];
+    const template_op_t *op;
+    size_t idx = 0;
+    int depth = 0, rc;
+
+    while (idx < count) {
+        op = &ops[idx];
+        switch (op->kind) {
+        case op_text:
+            rc = output_append(output, op->data, op->length);
+            if (rc < 0)
+                return rc;
+            idx++;
+            break;
+        case op_put:
+            rc = output_put(output, data, op->data);
+            if (rc < 0)
+                return rc;
+            idx++;
+            break;
+        case op_section:
+            rc = check_section(op, data);
+            if (rc < 0)
+                return rc;
+            if (op->flag == (rc != 0)) {
+                /* disabled content, skipped */
+                if (rc)
+                    leave(data);
+                idx = op->link + 1;
+            }
+            else {
+                entered[depth++] = rc;
+                idx++;
+            }
+            break;
+        case op_end:
+            rc = entered[--depth] ? next(data) : 0;
+            if (rc < 0)
+                return rc;
+            if (rc) {
+                /* again */
+                depth++;
+                idx = op->link + 1;
+            }
+            else {
+                if (entered[depth])
+                    leave(data);
+                idx++;
+            }
+            break;
+        }
+    }
+    return MUSTACH_OK;
+}
+
+/**
+ * @brief Compute the signature of the context for the template, the
+ * results of the permission checks of its sections. Without plugs,
+ * the rendering only depends on the signature and on the id.
+ *
+ * @param[in] ops the operations
+ * @param[in] count the count of operations
+ * @param[in] data the data of the template
+ * @param[out] signature the signature
+ * @return true if the rendering can be memorized
+ */
+__nonnull() __wur
+static bool get_signature(const template_op_t *ops, size_t count, template_data_t *data,
+                          uint64_t signature[TEMPLATE_MEMO_MAX_CHECKS / 64])
+{
+    size_t idx, nchecks = 0;
+    int rc;
+
+    if (data->context->plugset.first != NULL)
+        return false;
+
+    memset(signature, 0, TEMPLATE_MEMO_MAX_CHECKS / 8);
+    for (idx = 0 ; idx < count ; idx++) {
+        if (ops[idx].kind == op_section && ops[idx].data[0] == 'p' && ops[idx].data[1] == '=') {
+            if (nchecks == TEMPLATE_MEMO_MAX_CHECKS)
+                return false;
+            rc = check_section(&ops[idx], data);
+            if (rc < 0)
+                return false;
+            if (rc)
+                signature[nchecks / 64] |= (uint64_t)1 << (nchecks % 64);
+            nchecks++;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Append the memorized rendering to the output, filling its holes with the id
+ *
+ * @param[in] memo the memorized rendering
+ * @param[in] id the id
+ * @param[inout] output the output
+ * @return MUSTACH_OK or MUSTACH_ERROR_SYSTEM when out of memory
+ */
+__nonnull() __wur
+static int memo_splice(const template_memo_t *memo, const char *id, template_output_t *output)
+{
+    size_t idx, offset = 0;
+    int rc = MUSTACH_OK;
+
+    for (idx = 0 ; rc == MUSTACH_OK && idx < memo->nholes ; idx++) {
+        rc = output_append(output, &memo->text[offset], memo->holes[idx].offset - offset);
+        if (rc == MUSTACH_OK)
+            rc = output_value(output, id, memo->holes[idx].underscore);
+        offset = memo->holes[idx].offset;
+    }
+    if (rc == MUSTACH_OK)
+        rc = output_append(output, &memo->text[offset], memo->length - offset);
+    return rc;
+}
+
+/**
+ * @brief Search the memorized rendering of the template for the signature
+ * and make it the most recently used. Must be called with memo_mutex locked.
+ *
+ * @param[in] ops the compiled template
+ * @param[in] signature the signature
+ * @return the memorized rendering or NULL
+ */
+__nonnull() __wur
+static template_memo_t *memo_search(const template_op_t *ops, const uint64_t signature[TEMPLATE_MEMO_MAX_CHECKS / 64])
+{
+    template_memo_t *memo;
+
+    for (memo = memo_first ; memo != NULL ; memo = memo->next) {
+        if (memo->ops == ops && !memcmp(memo->signature, signature, sizeof memo->signature)) {
+            if (memo != memo_first) {
+                /* move to front */
+                memo->prev->next = memo->next;
+                if (memo->next != NULL)
+                    memo->next->prev = memo->prev;
+                else
+                    memo_last = memo->prev;
+                memo->prev = NULL;
+                memo->next = memo_first;
+                memo_first->prev = memo;
+                memo_first = memo;
+            }
+            return memo;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Unlink and free the memorized rendering. Must be called with
+ * memo_mutex locked.
+ *
+ * @param[in] memo the memorized rendering
+ */
+__nonnull()
+static void memo_remove(template_memo_t *memo)
+{
+    if (memo->prev != NULL)
+        memo->prev->next = memo->next;
+    else
+        memo_first = memo->next;
+    if (memo->next != NULL)
+        memo->next->prev = memo->prev;
+    else
+        memo_last = memo->prev;
+    memo_count--;
+    free(memo->text);
+    free(memo->holes);
+    free(memo);
+}
+
+/**
+ * @brief Forget the memorized renderings of the template
+ *
+ * @param[in] ops the compiled template
+ */
+__nonnull()
+static void memo_forget(const template_op_t *ops)
+{
+    template_memo_t *memo, *next;
+
+    pthread_mutex_lock(&memo_mutex);
+    for (memo = memo_first ; memo != NULL ; memo = next) {
+        next = memo->next;
+        if (memo->ops == ops)
+            memo_remove(memo);
+    }
+    pthread_mutex_unlock(&memo_mutex);
+}
+
+/**
+ * @brief Render the compiled template, reusing the memorized rendering
+ * of contexts having the same signature
+ *
+ * @param[in] ops the operations
+ * @param[in] count the count of operations
+ * @param[in] data the data of the template
+ * @param[inout] output the output receiving the rendered text
+ * @return MUSTACH_OK or a negative value on error
+ */
+__nonnull() __wur
+static int render_memo(const template_op_t *ops, size_t count, template_data_t *data, template_output_t *output)
+{
+    uint64_t signature[TEMPLATE_MEMO_MAX_CHECKS / 64];
+    template_output_t blank = { .text = NULL, .length = 0, .size = 0, .record = true, .holes = NULL, .nholes = 0 };
+    template_memo_t *memo;
+    int rc;
+
+    if (TEMPLATE_MEMO_SIZE == 0 || !get_signature(ops, count, data, signature))
+        return render(ops, count, data, output);
+
+    /* reuse the memorized rendering */
+    pthread_mutex_lock(&memo_mutex);
+    memo = memo_search(ops, signature);
+    if (memo != NULL) {
+        memo_hits++;
+        rc = memo_splice(memo, data->context->id, output);
+        pthread_mutex_unlock(&memo_mutex);
+        return rc;
+    }
+    memo_misses++;
+    pthread_mutex_unlock(&memo_mutex);
+
+    /* render without the id */
+    rc = render(ops, count, data, &blank);
+    memo = rc < 0 ? NULL : malloc(sizeof *memo);
+    if (memo == NULL) {
+        free(blank.text);
+        free(blank.holes);
+        return rc < 0 ? rc : render(ops, count, data, output);
+    }
+    memo->ops = ops;
+    memcpy(memo->signature, signature, sizeof memo->signature);
+    memo->text = blank.text;
+    memo->length = blank.length;
+    memo->holes = blank.holes;
+    memo->nholes = blank.nholes;
+    rc = memo_splice(memo, data->context->id, output);
+
+    /* memorize it, dropping the least recently used */
+    pthread_mutex_lock(&memo_mutex);
+    if (memo_search(ops, signature) != NULL) {
+        /* memorized meanwhile */
+        free(memo->text);
+        free(memo->holes);
+        free(memo);
+    }
+    else {
+        memo->prev = NULL;
+        memo->next = memo_first;
+        if (memo_first != NULL)
+            memo_first->prev = memo;
+        else
+            memo_last = memo;
+        memo_first = memo;
+        if (++memo_count > TEMPLATE_MEMO_SIZE)
+            memo_remove(memo_last);
+    }
+    pthread_mutex_unlock(&memo_mutex);
+    return rc;
+}
+
+/**
+ * @brief Release a reference to a cached template
+ *
+ * @param[in] entry the cached template
+ */
+__nonnull()
+static void entry_unref(template_entry_t *entry)
+{
+    unsigned refcount;
+
+    pthread_mutex_lock(&cache_mutex);
+    refcount = --entry->refcount;
+    pthread_mutex_unlock(&cache_mutex);
+    if (refcount == 0) {
+        if (entry->ops != NULL)
+            memo_forget(entry->ops);
+        free(entry->ops);
+        free(entry->text);
+        free(entry);
+    }
+}
+
+/**
+ * @brief Give their bit to the sections checking permissions referenced
+ * by the templates, the other sections keep the bit -1
+ *
+ * @param[inout] ops the compiled operations
+ * @param[in] count the count of operations
+ */
+__nonnull()
+static void bind_sections(template_op_t *ops, size_t count)
+{
+    template_op_t *op;
+    int rc;
+
+    for (op = ops ; op != &ops[count] ; op++) {
+        if (op->kind == op_section && op->data[0] == 'p' && op->data[1] == '=') {
+            rc = context_referenced_permission_bit(&op->data[2]);
+            op->bit = rc >= 0 ? rc : -1;
+        }
+    }
+}
+
+/**
+ * @brief Get the cached template of path, reading and compiling it
+ * if not cached or changed since cached
+ *
+ * @param[in] path the path of the template
+ * @param[out] result the cached template, to be released with entry_unref
+ * @return 0 on success or a negative -errno value
+ */
+__nonnull() __wur
+static int entry_get(const char *path, template_entry_t **result)
+{
+    template_entry_t *entry, **prev, *old = NULL;
+    struct stat st;
+    size_t length;
+    char *text;
+
+    if (stat(path, &st) < 0)
+        return -errno;
+
+    /* search a cached template not changed */
+    pthread_mutex_lock(&cache_mutex);
+    for (entry = cache ; entry != NULL ; entry = entry->next)
+        if (!strcmp(entry->path, path))
+            break;
+    if (entry != NULL
+     && entry->stat.st_dev == st.st_dev
+     && entry->stat.st_ino == st.st_ino
+     && entry->stat.st_size == st.st_size
+     && entry->stat.st_mtim.tv_sec == st.st_mtim.tv_sec
+     && entry->stat.st_mtim.tv_nsec == st.st_mtim.tv_nsec) {
+        entry->refcount++;
+        pthread_mutex_unlock(&cache_mutex);
+        *result = entry;
+        return 0;
+    }
+    pthread_mutex_unlock(&cache_mutex);
+
+    /* read and compile the template */
+    length = strlen(path);
+    entry = malloc(sizeof *entry + length + 1);
+    if (entry == NULL)
+        return -ENOMEM;
+    entry->text = read_file(path);
+    if (entry->text == NULL) {
+        free(entry);
+        return -EINVAL;
+    }
+    text = strdup(entry->text);
+    if (text != NULL && template_compile(text, &entry->ops, &entry->count) == MUSTACH_OK) {
+        free(entry->text);
+        entry->text = text;
+        bind_sections(entry->ops, entry->count);
+    }
+    else {
+        if (text != NULL)
+            free(entry->ops);
+        free(text);
+        entry->ops = NULL;
+        entry->count = 0;
+    }
+    entry->stat = st;
+    entry->refcount = 2;
+    memcpy(entry->path, path, length + 1);
+
+    /* cache it in place of the previous one */
+    pthread_mutex_lock(&cache_mutex);
+    for (prev = &cache ; *prev != NULL ; prev = &(*prev)->next) {
+        if (!strcmp((*prev)->path, path)) {
+            old = *prev;
+            *prev = old->next;
+            break;
+        }
+    }
+    entry->next = cache;
+    cache = entry;
+    pthread_mutex_unlock(&cache_mutex);
+    if (old != NULL)
+        entry_unref(old);
+
+    *result = entry;
+    return 0;
+}
+
+/**
+ * @brief Terminate the rendered text with a zero, not counted in its length
+ *
+ * @param[inout] output the output
+ * @return 0 in case of success or -ENOMEM
+ */
+__nonnull() __wur
+static int output_end(template_output_t *output)
+{
+    if (output_append(output, "", 1) != MUSTACH_OK)
+        return -ENOMEM;
+    output->length--;
+    return 0;
+}
+
+/* see template.h */
+int template_render(const char *template_path, const context_t *context, char **text, size_t *length) {
     int rc = 0;
-    int rc2 = 0;
     template_data_t data = { .context = context, .plug = NULL };
+    template_entry_t *entry = NULL;
+    template_output_t output = { .text = NULL, .length = 0, .size = 0, .record = false, .holes = NULL, .nholes = 0 };
 
-    char *template = read_file(template_path);
-    if (template == NULL) {
-        ERROR("read_file : %s", template_path);
+    rc = entry_get(template_path, &entry);
+    if (rc < 0) {
+        ERROR("read template %s : %d %s", template_path, -rc, strerror(-rc));
         return -EINVAL;
     }
 
-    FILE *f_dest = fopen(dest, "w");
-    if (f_dest == NULL) {
-        ERROR("fopen : %s", dest);
-        rc = -EINVAL;
-        goto end;
+    if (entry->ops != NULL) {
+        rc = render_memo(entry->ops, entry->count, &data, &output);
+        if (rc >= 0)
+            rc = output_end(&output);
     }
-
-    rc = fmustach(template, &itf, &data, f_dest);
+    else
+        rc = mustach(entry->text, &itf, &data, &output.text, &output.length);
+    entry_unref(entry);
     if (rc < 0) {
         ERROR("fmustach : %d %s", errno, strerror(errno));
+        free(output.text);
+        return rc;
     }
 
-    rc2 = fclose(f_dest);
-    if (rc2 < 0) {
-        ERROR("fclose %s : %d %s", dest, errno, strerror(errno));
+    *text = output.text;
+    *length = output.length;
+    return 0;
+}
+
+/* see template.h */
+int template_render_builtin(const template_builtin_t *builtin, const context_t *context, char **text, size_t *length) {
+    int rc;
+    template_data_t data = { .context = context, .plug = NULL };
+    template_output_t output = { .text = NULL, .length = 0, .size = 0, .record = false, .holes = NULL, .nholes = 0 };
+
+    rc = render_memo(builtin->ops, builtin->count, &data, &output);
+    if (rc >= 0)
+        rc = output_end(&output);
+    if (rc < 0) {
+        ERROR("render %s : %d %s", builtin->name, errno, strerror(errno));
+        free(output.text);
+        return rc;
     }
 
-end:
-    free(template);
+    *text = output.text;
+    *length = output.length;
+    return 0;
+}
+
+/**
+ * @brief Write the rendered text in the file dest
+ *
+ * @param[in] dest the path of the file
+ * @param[in] text the rendered text
+ * @param[in] length the length of the text
+ * @return 0 in case of success or a negative -errno value
+ */
+__nonnull() __wur
+static int write_output(const char *dest, const char *text, size_t length)
+{
+    int rc = write_file(dest, text, length);
+    if (rc < 0)
+        ERROR("write_file %s : %d %s", dest, -rc, strerror(-rc));
+    return rc;
+}
+
+/* see template.h */
+int template_process(const char *template_path, const char *dest, const context_t *context) {
+    char *text;
+    size_t length;
+
+    /* render in memory, the destination is untouched on error */
+    int rc = template_render(template_path, context, &text, &length);
+    if (rc >= 0) {
+        rc = write_output(dest, text, length);
+        free(text);
+    }
     return rc;
 }
 
+/* see template.h */
+int template_process_builtin(const template_builtin_t *builtin, const char *dest, const context_t *context) {
+    char *text;
+    size_t length;
+
+    int rc = template_render_builtin(builtin, context, &text, &length);
+    if (rc >= 0) {
+        rc = write_output(dest, text, length);
+        free(text);
+    }
+    return rc;
+}
+
+/* see template.h */
+int template_reference_permissions(const char *template_path) {
+    char permission[SEC_LSM_MANAGER_MAX_SIZE_PERMISSION + 1];
+    const char *beg, *end;
+    size_t len;
+    int rc = 0;
+
+    char *template = read_file(template_path);
+    if (template == NULL) {
+        ERROR("read_file : %s", template_path);
+        return -EINVAL;
+    }
+
+    /* scan the tags {{#p=...}} and {{^p=...}} */
+    for (end = template ; rc >= 0 && (beg = strstr(end, "{{")) != NULL ; ) {
+        beg += 2;
+        end = strstr(beg, "}}");
+        if (end == NULL)
+            break;
+        if (*beg != '#' && *beg != '^')
+            continue;
+        for (beg++ ; beg < end && isspace((unsigned char)*beg) ; beg++);
+        for (len = (size_t)(end - beg) ; len && isspace((unsigned char)beg[len - 1]) ; len--);
+        if (len < 2 || beg[0] != 'p' || beg[1] != '=' || len - 2 > SEC_LSM_MANAGER_MAX_SIZE_PERMISSION)
+            continue;
+        memcpy(permission, &beg[2], len - 2);
+        permission[len - 2] = '\0';
+        rc = context_reference_permission(permission);
+        if (rc < 0)
+            ERROR("context_reference_permission %s : %d %s", permission, -rc, strerror(-rc));
+    }
+
+    free(template);
+    return rc < 0 ? rc : 0;
+}
+
+/* see template.h */
+int template_reference_builtin(template_builtin_t *builtin) {
+    template_op_t *op;
+    int rc;
+
+    for (op = builtin->ops ; op != &builtin->ops[builtin->count] ; op++) {
+        if (op->kind == op_section && op->data[0] == 'p' && op->data[1] == '=') {
+            rc = context_reference_permission(&op->data[2]);
+            if (rc < 0) {
+                ERROR("context_reference_permission %s : %d %s", &op->data[2], -rc, strerror(-rc));
+                return rc;
+            }
+            op->bit = rc;
+        }
+    }
+    return 0;
+}
+
+/* see template.h */
+void template_memo_counters(unsigned long *hits, unsigned long *misses) {
+    pthread_mutex_lock(&memo_mutex);
+    *hits = memo_hits;
+    *misses = memo_misses;
+    pthread_mutex_unlock(&memo_mutex);
+}
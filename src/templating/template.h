@@ -25,7 +25,75 @@
 #define SEC_LSM_MANAGER_TEMPLATE_H
 
 #include "context/context.h"
+#include "templating/template-compile.h"
 
 extern int template_process(const char *template, const char *dest, const context_t *context);
 
+/**
+ * @brief Render the template in memory
+ *
+ * @param[in] template the path of the template
+ * @param[in] context the context of the application
+ * @param[out] text the rendered text, terminated by a zero, to be freed
+ * @param[out] length the length of the rendered text
+ * @return 0 in case of success or a negative value
+ */
+__wur __nonnull()
+extern int template_render(const char *template, const context_t *context, char **text, size_t *length);
+
+/**
+ * @brief Render in memory the template compiled at build time
+ *
+ * @param[in] builtin the compiled template
+ * @param[in] context the context of the application
+ * @param[out] text the rendered text, terminated by a zero, to be freed
+ * @param[out] length the length of the rendered text
+ * @return 0 in case of success or a negative value
+ */
+__wur __nonnull()
+extern int template_render_builtin(const template_builtin_t *builtin, const context_t *context, char **text, size_t *length);
+
+/**
+ * @brief Process the template compiled at build time, see template-gen.c
+ *
+ * @param[in] builtin the compiled template
+ * @param[in] dest the path of the file to write
+ * @param[in] context the context of the application
+ * @return 0 in case of success or a negative value
+ */
+__wur __nonnull()
+extern int template_process_builtin(const template_builtin_t *builtin, const char *dest, const context_t *context);
+
+/**
+ * @brief Reference the permissions checked by the sections of the template
+ * (sections {{#p=PERMISSION}} or {{^p=PERMISSION}}), see context_reference_permission
+ *
+ * @param[in] template the path of the template
+ * @return 0 in case of success or a negative -errno value
+ */
+__wur __nonnull()
+extern int template_reference_permissions(const char *template);
+
+/**
+ * @brief Reference the permissions checked by the sections of the template
+ * compiled at build time. These sections then check the bits of the
+ * permissions directly.
+ *
+ * @param[in] builtin the compiled template
+ * @return 0 in case of success or a negative -errno value
+ */
+__wur __nonnull()
+extern int template_reference_builtin(template_builtin_t *builtin);
+
+/**
+ * @brief Get the counters of the memorized renderings. Contexts without
+ * plugs having the same results for the permission checks of a compiled
+ * template share a rendering where only the id changes.
+ *
+ * @param[out] hits count of renderings reused
+ * @param[out] misses count of renderings memorized
+ */
+__nonnull()
+extern void template_memo_counters(unsigned long *hits, unsigned long *misses);
+
 #endif /* SEC_LSM_MANAGER_TEMPLATE_H */
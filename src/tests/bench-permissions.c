@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020-2026 IoT.bzh Company
+ * Author: Arthur Guyader <arthur.guyader@iot.bzh>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Benchmark of permission sets of 10, 100 and 1000 entries.
+ * It is not part of the unit tests: run it by hand to compare the
+ * timings of permission_set_add and permission_set_has.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "context/permissions.h"
+
+static double elapsed_ns(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) * 1e9 + (double)(now.tv_nsec - start->tv_nsec);
+}
+
+int main(void)
+{
+    static const int counts[] = { 10, 100, 1000 };
+    permission_set_t permission_set;
+    struct timespec start;
+    double tadd, thas;
+    char perm[64];
+    int c, i, rc, round, rounds, found;
+
+    for (c = 0 ; c < (int)(sizeof counts / sizeof *counts) ; c++) {
+        rounds = 100000 / counts[c];
+        tadd = thas = 0;
+        found = 0;
+        for (round = 0 ; round < rounds ; round++) {
+            permission_set_init(&permission_set);
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (i = 0 ; i < counts[c] ; i++) {
+                snprintf(perm, sizeof perm, "urn:redpesk:permission:api:%d:level", i);
+                rc = permission_set_add(&permission_set, perm);
+                if (rc < 0) {
+                    fprintf(stderr, "error can't add %s: %s\n", perm, strerror(-rc));
+                    return EXIT_FAILURE;
+                }
+            }
+            tadd += elapsed_ns(&start);
+
+            /* half of the lookups hit, with another case */
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (i = 0 ; i < 2 * counts[c] ; i++) {
+                snprintf(perm, sizeof perm, "URN:REDPESK:PERMISSION:API:%d:LEVEL", i);
+                found += permission_set_has(&permission_set, perm);
+            }
+            thas += elapsed_ns(&start);
+            permission_set_clear(&permission_set);
+        }
+        if (found != rounds * counts[c]) {
+            fprintf(stderr, "error %d permissions found instead of %d\n", found, rounds * counts[c]);
+            return EXIT_FAILURE;
+        }
+        printf("permission_set of %4d entries: add %6.1f ns, has %6.1f ns\n", counts[c],
+               tadd / (rounds * counts[c]), thas / (2 * rounds * counts[c]));
+    }
+    return EXIT_SUCCESS;
+}
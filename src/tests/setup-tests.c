@@ -97,6 +97,9 @@ int main(int argc, char const *argv[]) {
     addtcase("permissions");
     test_permissions();
 
+    addtcase("arena");
+    test_arena();
+
     addtcase("context");
     test_context();
 
@@ -111,7 +114,7 @@ int main(int argc, char const *argv[]) {
     test_cynagora();
 #endif
 
-#if WITH_SMACK && !SIMULATE_SMACK
+#if WITH_SMACK
     addtcase("smack");
     test_smack();
     test_smack_label();
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018-2026 IoT.bzh Company
+ * Author: José Bollo <jose.bollo@iot.bzh>
+ *
+ * $RP_BEGIN_LICENSE$
+ * Commercial License Usage
+ *  Licensees holding valid commercial IoT.bzh licenses may use this file in
+ *  accordance with the commercial license agreement provided with the
+ *  Software or, alternatively, in accordance with the terms contained in
+ *  a written agreement between you and The IoT.bzh Company. For licensing terms
+ *  and conditions see https://www.iot.bzh/terms-conditions. For further
+ *  information use the contact form at https://www.iot.bzh/contact.
+ *
+ * GNU General Public License Usage
+ *  Alternatively, this file may be used under the terms of the GNU General
+ *  Public license version 3. This license is as published by the Free Software
+ *  Foundation and appearing in the file LICENSE.GPLv3 included in the packaging
+ *  of this file. Please review the following information to ensure the GNU
+ *  General Public License requirements will be met
+ *  https://www.gnu.org/licenses/gpl-3.0.html.
+ * $RP_END_LICENSE$
+ */
+
+#include "setup-tests.h"
+
+#include <errno.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "context/arena.h"
+#include "context/paths.h"
+#include "context/plugs.h"
+
+START_TEST(test_arena_alloc) {
+    arena_t arena;
+    char *a, *b, *big;
+
+    arena_init(&arena, 1 << 20);
+    ck_assert_ptr_null(arena.blocks);
+
+    a = arena_alloc(&arena, 3);
+    b = arena_alloc(&arena, 5);
+    ck_assert_ptr_nonnull(a);
+    ck_assert_ptr_nonnull(b);
+    ck_assert_int_eq((int)((uintptr_t)a % alignof(max_align_t)), 0);
+    ck_assert_int_eq((int)((uintptr_t)b % alignof(max_align_t)), 0);
+    memcpy(a, "ab", 3);
+    memcpy(b, "cdef", 5);
+
+    /* big allocations don't waste the current block */
+    big = arena_alloc(&arena, 100000);
+    ck_assert_ptr_nonnull(big);
+    memset(big, 'x', 100000);
+    ck_assert_ptr_eq(arena_alloc(&arena, 1), b + alignof(max_align_t));
+    ck_assert_str_eq(a, "ab");
+    ck_assert_str_eq(b, "cdef");
+
+    /* reset keeps one block */
+    arena_reset(&arena);
+    ck_assert_ptr_nonnull(arena.blocks);
+    ck_assert_ptr_eq(arena_alloc(&arena, 8), a);
+
+    arena_release(&arena);
+    ck_assert_ptr_null(arena.blocks);
+    ck_assert_int_eq((int)arena.total, 0);
+}
+END_TEST
+
+START_TEST(test_arena_limit) {
+    arena_t arena;
+    path_set_t path_set;
+    plugset_t plugset;
+    char buf[100];
+    int i, rc;
+
+    arena_init(&arena, 65536);
+    ck_assert_ptr_null(arena_alloc(&arena, 65537));
+    ck_assert_ptr_nonnull(arena_alloc(&arena, 65536));
+    ck_assert_ptr_null(arena_alloc(&arena, 1));
+    arena_release(&arena);
+
+    /* the sets stop when the arena is full */
+    arena_init(&arena, 65536);
+    path_set_init(&path_set, &arena);
+    plugset_init(&plugset, &arena);
+    for (i = 0, rc = 0 ; rc == 0 ; i++) {
+        snprintf(buf, sizeof buf, "/opt/app/%d", i);
+        rc = path_set_add(&path_set, buf, type_data);
+        if (rc == 0)
+            rc = plugset_add(&plugset, buf, "id", buf);
+    }
+    ck_assert_int_eq(rc, -ENOMEM);
+    ck_assert_int_gt(i, 100);
+    ck_assert_int_le((int)arena.total, 65536);
+    ck_assert_str_eq(path_set.paths[100]->path, "/opt/app/100");
+
+    path_set_clear(&path_set);
+    plugset_clear(&plugset);
+    ck_assert_ptr_null(plugset.first);
+    arena_reset(&arena);
+    ck_assert_int_eq(path_set_add(&path_set, "/opt/app", type_data), 0);
+    path_set_clear(&path_set);
+    arena_release(&arena);
+}
+END_TEST
+
+void test_arena(void) {
+    addtest(test_arena_alloc);
+    addtest(test_arena_limit);
+}
@@ -24,8 +24,18 @@
 #include "setup-tests.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "context/context.h"
+#include "file-utils.h"
+#include "protocol/manifest.h"
+#include "templating/template.h"
 
 START_TEST(test_init_context) {
     context_t context;
@@ -59,6 +69,12 @@ START_TEST(test_context_set_id) {
     ck_assert_str_eq(context->id, "id");
     // test duplicate set id
     ck_assert_int_eq(context_set_id(context, "id2"), -EEXIST);
+    // test shorter id after clear
+    context_clear(context);
+    ck_assert_int_eq(context_set_id(context, "long-id"), 0);
+    context_clear(context);
+    ck_assert_int_eq(context_set_id(context, "id"), 0);
+    ck_assert_str_eq(context->id, "id");
     context_destroy(context);
 
     ck_assert_int_eq(context_create(&context), 0);
@@ -151,6 +167,318 @@ START_TEST(test_destroy_context) {
 }
 END_TEST
 
+static int manifest_file(const char *data, size_t size, bool sealed) {
+    int fd = memfd_create("manifest", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    ck_assert_int_le(0, fd);
+    ck_assert_int_eq((int)size, (int)write(fd, data, size));
+    if (sealed)
+        ck_assert_int_eq(0, fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_WRITE));
+    return fd;
+}
+
+START_TEST(test_context_manifest) {
+    static const char good[] = "sec-lsm-manager-manifest\0" "1\0"
+                               "\003\0id\0"
+                               "\006\0/tmp\0conf\0"
+                               "\007\0perm\0";
+#define BAD(data) { data, sizeof data }
+    static const struct { const char *data; size_t size; } bads[] = {
+        BAD("sec-lsm-manager-manifest"),
+        BAD("sec-lsm-manager-manifest\0" "2"),
+        BAD("sec-lsm-manager-manifest\0" "1\0" "\003"),
+        BAD("sec-lsm-manager-manifest\0" "1\0" "\003\0" "id\0" "\006\0" "/tmp"),
+        BAD("sec-lsm-manager-manifest\0" "1\0" "\016\0" "x"),
+        BAD("sec-lsm-manager-manifest\0" "1\0" "\007\0" "\xff"),
+    };
+#undef BAD
+    char path[] = "/tmp/test-manifest-XXXXXX";
+    context_t *context = NULL;
+    unsigned i;
+    int fd;
+
+    // load from memory
+    ck_assert_int_eq(context_create(&context), 0);
+    ck_assert_int_eq(manifest_load(context, good, sizeof good - 1), 0);
+    ck_assert_str_eq(context->id, "id");
+    ck_assert_int_eq((int)context->path_set.size, 1);
+    ck_assert_str_eq(context->path_set.paths[0]->path, "/tmp");
+    ck_assert_int_eq((int)context->permission_set.size, 1);
+
+    // same checks than requests
+    ck_assert_int_eq(manifest_load(context, good, sizeof good - 1), -EEXIST);
+    context_destroy(context);
+
+    // malformed manifests
+    for (i = 0 ; i < sizeof bads / sizeof *bads ; i++) {
+        ck_assert_int_eq(context_create(&context), 0);
+        ck_assert_int_eq(manifest_load(context, bads[i].data, bads[i].size), -EBADMSG);
+        context_destroy(context);
+    }
+
+    // load from a sealed memory file
+    ck_assert_int_eq(context_create(&context), 0);
+    fd = manifest_file(good, sizeof good - 1, true);
+    ck_assert_int_eq(manifest_load_fd(context, fd), 0);
+    ck_assert_str_eq(context->id, "id");
+    ck_assert_int_eq((int)context->permission_set.size, 1);
+    close(fd);
+    context_destroy(context);
+
+    // other files are not read
+    ck_assert_int_eq(context_create(&context), 0);
+    fd = manifest_file(good, sizeof good - 1, false);
+    ck_assert_int_eq(manifest_load_fd(context, fd), -EBADF);
+    close(fd);
+    fd = mkstemp(path);
+    ck_assert_int_le(0, fd);
+    ck_assert_int_eq((int)sizeof good - 1, (int)write(fd, good, sizeof good - 1));
+    ck_assert_int_eq(manifest_load_fd(context, fd), -EBADF);
+    close(fd);
+    unlink(path);
+    ck_assert_int_eq((int)context->permission_set.size, 0);
+    context_destroy(context);
+}
+END_TEST
+
+static void make_temp_pair(char tpath[], char dpath[])
+{
+    int fd;
+
+    fd = mkstemp(tpath);
+    ck_assert_int_le(0, fd);
+    close(fd);
+    fd = mkstemp(dpath);
+    ck_assert_int_le(0, fd);
+    close(fd);
+}
+
+static void remove_temp_pair(const char *tpath, const char *dpath)
+{
+    unlink(tpath);
+    unlink(dpath);
+}
+
+static void write_template(const char *path, const char *text, time_t mtime)
+{
+    struct timespec times[2] = { { mtime, 0 }, { mtime, 0 } };
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    ck_assert_int_le(0, fd);
+    ck_assert_int_eq((int)strlen(text), (int)write(fd, text, strlen(text)));
+    ck_assert_int_eq(0, futimens(fd, times));
+    close(fd);
+}
+
+static void check_template(const char *tpath, const char *dpath, context_t *context, const char *expected)
+{
+    char *rendered;
+    size_t length;
+
+    ck_assert_int_eq(template_process(tpath, dpath, context), 0);
+    rendered = read_file(dpath);
+    ck_assert_str_eq(rendered, expected);
+    free(rendered);
+
+    // the rendering in memory gives the same text
+    ck_assert_int_eq(template_render(tpath, context, &rendered, &length), 0);
+    ck_assert_str_eq(rendered, expected);
+    ck_assert_int_eq((int)length, (int)strlen(expected));
+    free(rendered);
+}
+
+START_TEST(test_context_referenced_permission) {
+    static const char template[] = "{{#p=urn:a}}a{{/p=urn:a}}"
+                                   "{{^ p=urn:b }}!b{{/ p=urn:b }}"
+                                   "{{#p=urn:c}}c{{/p=urn:c}}"
+                                   "{{id}}{{#p=urn:a}}{{/p=urn:a}}";
+    char tpath[] = "/tmp/test-template-XXXXXX";
+    char dpath[] = "/tmp/test-rendered-XXXXXX";
+    char *rendered;
+    context_t *context = NULL;
+
+    make_temp_pair(tpath, dpath);
+    write_template(tpath, template, 1000);
+
+    // referenced permissions get bits in their order
+    ck_assert_int_eq(template_reference_permissions(tpath), 0);
+    ck_assert_int_eq(context_reference_permission("URN:A"), 0);
+    ck_assert_int_eq(context_reference_permission("urn:b"), 1);
+    ck_assert_int_eq(context_reference_permission("urn:c"), 2);
+    ck_assert_int_eq(context_reference_permission("x"), -EINVAL);
+
+    ck_assert_int_eq(context_create(&context), 0);
+    ck_assert_int_eq(context_add_permission(context, "urn:c"), 0);
+    ck_assert_int_eq(context_add_permission(context, "urn:d"), 0);
+    ck_assert_int_eq((int)context->referenced_bits[0], 4);
+    ck_assert_int_eq(context_has_permission(context, "urn:a"), 0);
+    ck_assert_int_eq(context_has_permission(context, "urn:b"), 0);
+    ck_assert_int_eq(context_has_permission(context, "URN:C"), 1);
+    ck_assert_int_eq(context_has_permission(context, "urn:d"), 1);
+    ck_assert_int_eq(context_set_id(context, "app"), 0);
+
+    ck_assert_int_eq(template_process(tpath, dpath, context), 0);
+    rendered = read_file(dpath);
+    ck_assert_str_eq(rendered, "!bcapp");
+    free(rendered);
+
+    context_clear(context);
+    ck_assert_int_eq((int)context->referenced_bits[0], 0);
+    ck_assert_int_eq(context_has_permission(context, "urn:c"), 0);
+    context_destroy(context);
+    remove_temp_pair(tpath, dpath);
+}
+END_TEST
+
+START_TEST(test_template_cache) {
+    char tpath[] = "/tmp/test-template-XXXXXX";
+    char dpath[] = "/tmp/test-rendered-XXXXXX";
+    context_t *context = NULL;
+    char *rendered;
+
+    make_temp_pair(tpath, dpath);
+
+    ck_assert_int_eq(context_create(&context), 0);
+    ck_assert_int_eq(context_set_id(context, "my-app"), 0);
+    ck_assert_int_eq(context_add_plug(context, "/tmp", "imp-a", "/tmp"), 0);
+
+    write_template(tpath, "{{id}} {{_id_}}{{! comment }}{{=<% %>=}}<%#plugs%>[<%impid%>]<%/plugs%>"
+                          "<%^has-plugs%>none<%/has-plugs%>", 1000);
+    check_template(tpath, dpath, context, "my-app my_app[imp-a]");
+    check_template(tpath, dpath, context, "my-app my_app[imp-a]");
+
+    // changes are detected by size and time
+    write_template(tpath, "{{#has-plugs}}plugs {{/has-plugs}}{{id_underscore}}", 1000);
+    check_template(tpath, dpath, context, "plugs my_app");
+    write_template(tpath, "{{#has-plugs}}PLUGS {{/has-plugs}}{{id_underscore}}", 2000);
+    check_template(tpath, dpath, context, "PLUGS my_app");
+
+    // partials are processed as before
+    write_template(tpath, "<{{>id}}>", 3000);
+    check_template(tpath, dpath, context, "<my-app>");
+
+    // errors are reported as before and the destination is untouched
+    write_template(tpath, "{{#plugs}}", 4000);
+    ck_assert_int_lt(template_process(tpath, dpath, context), 0);
+    rendered = read_file(dpath);
+    ck_assert_str_eq(rendered, "<my-app>");
+    free(rendered);
+
+    context_destroy(context);
+    remove_temp_pair(tpath, dpath);
+}
+END_TEST
+
+START_TEST(test_template_builtin) {
+    static const char text[] = "{{id}}:{{#p=perm-a}}A{{/p=perm-a}}{{^p=perm-b}}B{{/p=perm-b}}"
+                               "{{#plugs}}[{{_impid_}}]{{/plugs}}";
+    char tpath[] = "/tmp/test-template-XXXXXX";
+    char dpath[] = "/tmp/test-rendered-XXXXXX";
+    char copy[sizeof text];
+    template_builtin_t builtin = { .name = "test", .ops = NULL, .count = 0 };
+    context_t *context = NULL;
+    char *rendered;
+    size_t length;
+
+    make_temp_pair(tpath, dpath);
+    write_template(tpath, text, 1000);
+
+    // compile as template-gen does
+    memcpy(copy, text, sizeof text);
+    ck_assert_int_eq(template_compile(copy, &builtin.ops, &builtin.count), 0);
+    ck_assert_int_eq(builtin.ops[2].kind, op_section);
+    ck_assert_int_eq(builtin.ops[2].bit, -1);
+    ck_assert_int_eq(template_reference_builtin(&builtin), 0);
+    ck_assert_int_eq(builtin.ops[2].bit, context_reference_permission("perm-a"));
+
+    // the bits give the same result than the file
+    ck_assert_int_eq(context_create(&context), 0);
+    ck_assert_int_eq(context_set_id(context, "my-app"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm-a"), 0);
+    ck_assert_int_eq(context_add_plug(context, "/tmp", "imp-a", "/tmp"), 0);
+    ck_assert_int_eq(template_process_builtin(&builtin, dpath, context), 0);
+    rendered = read_file(dpath);
+    ck_assert_str_eq(rendered, "my-app:AB[imp_a]");
+    free(rendered);
+    check_template(tpath, dpath, context, "my-app:AB[imp_a]");
+    context_clear(context);
+    ck_assert_int_eq(context_set_id(context, "my-app"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm-b"), 0);
+    ck_assert_int_eq(template_process_builtin(&builtin, dpath, context), 0);
+    rendered = read_file(dpath);
+    ck_assert_str_eq(rendered, "my-app:");
+    free(rendered);
+    ck_assert_int_eq(template_render_builtin(&builtin, context, &rendered, &length), 0);
+    ck_assert_str_eq(rendered, "my-app:");
+    ck_assert_int_eq((int)length, 7);
+    free(rendered);
+    check_template(tpath, dpath, context, "my-app:");
+
+    context_destroy(context);
+    free(builtin.ops);
+    remove_temp_pair(tpath, dpath);
+}
+END_TEST
+
+START_TEST(test_template_memo) {
+    char tpath[] = "/tmp/test-template-XXXXXX";
+    char dpath[] = "/tmp/test-rendered-XXXXXX";
+    context_t *context = NULL;
+    unsigned long hits0, misses0, hits, misses;
+
+    make_temp_pair(tpath, dpath);
+    write_template(tpath, "{{id}}:{{#p=perm-a}}A {{_id_}}{{/p=perm-a}}{{^p=perm-b}}.{{id_underscore}}{{/p=perm-b}}"
+                          "{{#plugs}}[{{impid}}]{{/plugs}}", 1000);
+    template_memo_counters(&hits0, &misses0);
+
+    // the first rendering is memorized (check_template renders twice)
+    ck_assert_int_eq(context_create(&context), 0);
+    ck_assert_int_eq(context_set_id(context, "app-one"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm-a"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm-c"), 0);
+    check_template(tpath, dpath, context, "app-one:A app_one.app_one");
+    template_memo_counters(&hits, &misses);
+    ck_assert_int_eq((int)(hits - hits0), 1);
+    ck_assert_int_eq((int)(misses - misses0), 1);
+
+    // same checks, other id: reused
+    context_clear(context);
+    ck_assert_int_eq(context_set_id(context, "app-two-x"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm-a"), 0);
+    check_template(tpath, dpath, context, "app-two-x:A app_two_x.app_two_x");
+    template_memo_counters(&hits, &misses);
+    ck_assert_int_eq((int)(hits - hits0), 3);
+    ck_assert_int_eq((int)(misses - misses0), 1);
+
+    // other checks
+    context_clear(context);
+    ck_assert_int_eq(context_set_id(context, "app-three"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm-b"), 0);
+    check_template(tpath, dpath, context, "app-three:");
+    template_memo_counters(&hits, &misses);
+    ck_assert_int_eq((int)(hits - hits0), 4);
+    ck_assert_int_eq((int)(misses - misses0), 2);
+
+    // plugs are not memorized
+    ck_assert_int_eq(context_add_plug(context, "/tmp", "imp-a", "/tmp"), 0);
+    check_template(tpath, dpath, context, "app-three:[imp-a]");
+    template_memo_counters(&hits, &misses);
+    ck_assert_int_eq((int)(hits - hits0), 4);
+    ck_assert_int_eq((int)(misses - misses0), 2);
+
+    // a changed template forgets its renderings
+    write_template(tpath, "{{id}}:{{#p=perm-b}}B{{/p=perm-b}}", 2000);
+    context_clear(context);
+    ck_assert_int_eq(context_set_id(context, "app-fourth"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm-b"), 0);
+    check_template(tpath, dpath, context, "app-fourth:B");
+    template_memo_counters(&hits, &misses);
+    ck_assert_int_eq((int)(hits - hits0), 5);
+    ck_assert_int_eq((int)(misses - misses0), 3);
+
+    context_destroy(context);
+    remove_temp_pair(tpath, dpath);
+}
+END_TEST
+
 void test_context(void) {
     addtest(test_init_context);
     addtest(test_create_context);
@@ -159,4 +487,9 @@ void test_context(void) {
     addtest(test_context_add_path);
     addtest(test_free_context);
     addtest(test_destroy_context);
+    addtest(test_context_manifest);
+    addtest(test_context_referenced_permission);
+    addtest(test_template_cache);
+    addtest(test_template_builtin);
+    addtest(test_template_memo);
 }
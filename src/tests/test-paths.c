@@ -24,13 +24,17 @@
 #include "setup-tests.h"
 
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 #include "context/paths.h"
+#include "label-paths.h"
 
 START_TEST(test_init_path_set) {
     path_set_t path_set;
-    path_set_init(&path_set);
+    path_set_init(&path_set, NULL);
     ck_assert_ptr_eq(path_set.paths, NULL);
     ck_assert_int_eq((int)path_set.size, 0);
     path_set_clear(&path_set);
@@ -39,7 +43,7 @@ END_TEST
 
 START_TEST(test_free_path_set) {
     path_set_t path_set;
-    path_set_init(&path_set);
+    path_set_init(&path_set, NULL);
     ck_assert_int_eq(path_set_add(&path_set, "/test", type_data), 0);
     path_set_clear(&path_set);
     ck_assert_ptr_eq(path_set.paths, NULL);
@@ -49,7 +53,7 @@ END_TEST
 
 START_TEST(test_path_set_add_path) {
     path_set_t paths;
-    path_set_init(&paths);
+    path_set_init(&paths, NULL);
 
     ck_assert_int_eq(path_set_add(&paths, "/test", 10000), -EINVAL);
 
@@ -85,6 +89,34 @@ START_TEST(test_path_set_add_path) {
 }
 END_TEST
 
+START_TEST(test_path_set_has_path) {
+    path_set_t paths;
+    char buf[50];
+    int i;
+
+    path_set_init(&paths, NULL);
+    ck_assert_int_eq(path_set_has(&paths, "/test"), false);
+    for (i = 0 ; i < 2000 ; i++) {
+        snprintf(buf, sizeof buf, "/opt/app/data/f%d", i);
+        ck_assert_int_eq(path_set_add(&paths, buf, i & 1 ? type_data : type_conf), 0);
+    }
+    ck_assert_int_eq((int)paths.size, 2000);
+    ck_assert_int_ge((int)paths.capacity, 2000);
+
+    for (i = 0 ; i < 2000 ; i++) {
+        snprintf(buf, sizeof buf, "/opt/app/data/f%d", i);
+        ck_assert_str_eq(paths.paths[i]->path, buf);
+        ck_assert_int_eq((int)paths.paths[i]->path_type, i & 1 ? type_data : type_conf);
+        ck_assert_int_eq(path_set_has(&paths, buf), true);
+        snprintf(buf, sizeof buf, "/opt/app/data/F%d", i);
+        ck_assert_int_eq(path_set_has(&paths, buf), false);
+    }
+
+    path_set_clear(&paths);
+    ck_assert_int_eq(path_set_has(&paths, "/opt/app/data/f1"), false);
+}
+END_TEST
+
 START_TEST(test_valid_path_type) {
     ck_assert_int_eq(path_type_is_valid(type_unset), false);
     ck_assert_int_eq(path_type_is_valid(0), false);
@@ -140,11 +172,61 @@ START_TEST(test_get_path_type_string) {
 }
 END_TEST
 
+#define LABEL_TEST_COUNT 1000
+
+typedef struct {
+    int failing[2];
+    char labelled[LABEL_TEST_COUNT];
+} label_test_t;
+
+static int label_test(const path_t *path, const void *closure) {
+    label_test_t *test = (label_test_t *)(uintptr_t)closure;
+    int idx = atoi(&path->path[3]);
+
+    test->labelled[idx] = 1;
+    return idx == test->failing[0] ? -EACCES : idx == test->failing[1] ? -ENOENT : 0;
+}
+
+START_TEST(test_label_paths) {
+    char path[32];
+    path_set_t path_set;
+    label_test_t test;
+    int idx, loop;
+
+    path_set_init(&path_set, NULL);
+    for (idx = 0 ; idx < LABEL_TEST_COUNT ; idx++) {
+        snprintf(path, sizeof path, "/p/%d", idx);
+        ck_assert_int_eq(path_set_add(&path_set, path, type_data), 0);
+    }
+
+    // all paths are labelled
+    memset(&test, 0, sizeof test);
+    test.failing[0] = test.failing[1] = -1;
+    ck_assert_int_eq(label_paths(&path_set, label_test, &test), 0);
+    for (idx = 0 ; idx < LABEL_TEST_COUNT ; idx++)
+        ck_assert_int_eq(test.labelled[idx], 1);
+
+    // the error is the one of the first failing path
+    for (loop = 0 ; loop < 20 ; loop++) {
+        memset(&test, 0, sizeof test);
+        test.failing[0] = 700;
+        test.failing[1] = 300;
+        ck_assert_int_eq(label_paths(&path_set, label_test, &test), -ENOENT);
+        for (idx = 0 ; idx <= 300 ; idx++)
+            ck_assert_int_eq(test.labelled[idx], 1);
+    }
+
+    path_set_clear(&path_set);
+}
+END_TEST
+
 void test_paths(void) {
     addtest(test_init_path_set);
     addtest(test_free_path_set);
     addtest(test_path_set_add_path);
+    addtest(test_path_set_has_path);
     addtest(test_valid_path_type);
     addtest(test_get_path_type);
     addtest(test_get_path_type_string);
+    addtest(test_label_paths);
 }
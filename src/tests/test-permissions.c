@@ -17,6 +17,9 @@
 
 #include "setup-tests.h"
 
+#include <stdio.h>
+
+#include "context/interned.h"
 #include "context/permissions.h"
 
 START_TEST(test_init_permission_set) {
@@ -50,8 +53,67 @@ START_TEST(test_permission_set_add_permission) {
 }
 END_TEST
 
+START_TEST(test_permission_set_has_permission) {
+    permission_set_t permission_set;
+    char perm[64];
+    int i;
+
+    permission_set_init(&permission_set);
+    ck_assert_int_eq((int)permission_set_has(&permission_set, "perm"), 0);
+    for (i = 0 ; i < 300 ; i++) {
+        snprintf(perm, sizeof perm, "urn:redpesk:permission:%d", i);
+        ck_assert_int_eq(permission_set_add(&permission_set, perm), 0);
+    }
+    ck_assert_int_eq((int)permission_set.size, 300);
+
+    // order is kept and case is folded
+    for (i = 0 ; i < 300 ; i++) {
+        snprintf(perm, sizeof perm, "urn:redpesk:permission:%d", i);
+        ck_assert_str_eq(permission_set.permissions[i], perm);
+        snprintf(perm, sizeof perm, "URN:Redpesk:PERMISSION:%d", i);
+        ck_assert_int_eq((int)permission_set_has(&permission_set, perm), 1);
+        snprintf(perm, sizeof perm, "urn:redpesk:permission:%d", i + 300);
+        ck_assert_int_eq((int)permission_set_has(&permission_set, perm), 0);
+    }
+
+    // no duplicate
+    ck_assert_int_eq(permission_set_add(&permission_set, "URN:REDPESK:PERMISSION:7"), 0);
+    ck_assert_int_eq((int)permission_set.size, 300);
+    permission_set_clear(&permission_set);
+    ck_assert_int_eq((int)permission_set_has(&permission_set, "urn:redpesk:permission:7"), 0);
+}
+END_TEST
+
+START_TEST(test_permission_set_interned) {
+    permission_set_t set1, set2;
+    size_t count = interned_count();
+
+    permission_set_init(&set1);
+    permission_set_init(&set2);
+    ck_assert_int_eq(permission_set_add(&set1, "urn:redpesk:permission::public:a"), 0);
+    ck_assert_int_eq(permission_set_add(&set1, "urn:redpesk:permission::public:b"), 0);
+    ck_assert_int_eq(permission_set_add(&set2, "urn:redpesk:permission::public:b"), 0);
+    ck_assert_int_eq(permission_set_add(&set2, "URN:REDPESK:PERMISSION::PUBLIC:A"), 0);
+    ck_assert_int_eq((int)(interned_count() - count), 3);
+
+    // the same permissions are shared
+    ck_assert_ptr_eq(set1.permissions[1], set2.permissions[0]);
+    ck_assert_ptr_ne(set1.permissions[0], set2.permissions[1]);
+    ck_assert_int_eq((int)permission_set_has(&set1, set2.permissions[0]), 1);
+    ck_assert_int_eq((int)permission_set_has(&set1, set2.permissions[1]), 1);
+
+    permission_set_clear(&set1);
+    ck_assert_int_eq((int)(interned_count() - count), 2);
+    ck_assert_str_eq(set2.permissions[0], "urn:redpesk:permission::public:b");
+    permission_set_clear(&set2);
+    ck_assert_int_eq((int)interned_count(), (int)count);
+}
+END_TEST
+
 void test_permissions() {
     addtest(test_init_permission_set);
     addtest(test_free_permission_set);
     addtest(test_permission_set_add_permission);
+    addtest(test_permission_set_has_permission);
+    addtest(test_permission_set_interned);
 }
@@ -29,12 +29,12 @@ START_TEST(test_plugset_init)
 {
     plugset_t plugset;
 
-    plugset = (plug_t*)(intptr_t)8;
-    plugset_init(&plugset);
-    ck_assert_ptr_null(plugset);
+    plugset.first = (plug_t*)(intptr_t)8;
+    plugset_init(&plugset, NULL);
+    ck_assert_ptr_null(plugset.first);
 
     plugset_clear(&plugset);
-    ck_assert_ptr_null(plugset);
+    ck_assert_ptr_null(plugset.first);
 }
 END_TEST
 
@@ -42,45 +42,45 @@ START_TEST(test_plugset_deinit)
 {
     plugset_t plugset;
 
-    plugset = (plug_t*)(intptr_t)8;
-    plugset_init(&plugset);
-    ck_assert_ptr_null(plugset);
+    plugset.first = (plug_t*)(intptr_t)8;
+    plugset_init(&plugset, NULL);
+    ck_assert_ptr_null(plugset.first);
 
     ck_assert_int_eq(plugset_add(&plugset, "/tmp/a", "xb", "/tmp/c"), 0);
-    ck_assert_ptr_nonnull(plugset);
+    ck_assert_ptr_nonnull(plugset.first);
 
     ck_assert_int_eq(plugset_add(&plugset, "/tmp/u", "xv", "/tmp/w"), 0);
-    ck_assert_ptr_nonnull(plugset);
+    ck_assert_ptr_nonnull(plugset.first);
 
     plugset_clear(&plugset);
-    ck_assert_ptr_null(plugset);
+    ck_assert_ptr_null(plugset.first);
 }
 END_TEST
 
 START_TEST(test_plugset_add) {
     plugset_t plugset;
 
-    plugset = (plug_t*)(intptr_t)8;
-    plugset_init(&plugset);
-    ck_assert_ptr_null(plugset);
+    plugset.first = (plug_t*)(intptr_t)8;
+    plugset_init(&plugset, NULL);
+    ck_assert_ptr_null(plugset.first);
 
     ck_assert_int_eq(plugset_add(&plugset, "/tmp/a", "xb", "/tmp/c"), 0);
-    ck_assert_ptr_nonnull(plugset);
-    ck_assert_str_eq("/tmp/a", plugset->expdir);
-    ck_assert_str_eq("xb", plugset->impid);
-    ck_assert_str_eq("/tmp/c", plugset->impdir);
+    ck_assert_ptr_nonnull(plugset.first);
+    ck_assert_str_eq("/tmp/a", plugset.first->expdir);
+    ck_assert_str_eq("xb", plugset.first->impid);
+    ck_assert_str_eq("/tmp/c", plugset.first->impdir);
 
     ck_assert_int_eq(plugset_add(&plugset, "/tmp/u", "xv", "/tmp/w"), 0);
-    ck_assert_ptr_nonnull(plugset);
-    ck_assert_str_eq("/tmp/u", plugset->expdir);
-    ck_assert_str_eq("xv", plugset->impid);
-    ck_assert_str_eq("/tmp/w", plugset->impdir);
-    ck_assert_str_eq("/tmp/a", plugset->next->expdir);
-    ck_assert_str_eq("xb", plugset->next->impid);
-    ck_assert_str_eq("/tmp/c", plugset->next->impdir);
+    ck_assert_ptr_nonnull(plugset.first);
+    ck_assert_str_eq("/tmp/u", plugset.first->expdir);
+    ck_assert_str_eq("xv", plugset.first->impid);
+    ck_assert_str_eq("/tmp/w", plugset.first->impdir);
+    ck_assert_str_eq("/tmp/a", plugset.first->next->expdir);
+    ck_assert_str_eq("xb", plugset.first->next->impid);
+    ck_assert_str_eq("/tmp/c", plugset.first->next->impdir);
 
     plugset_clear(&plugset);
-    ck_assert_ptr_null(plugset);
+    ck_assert_ptr_null(plugset.first);
 }
 END_TEST
 
@@ -25,9 +25,16 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "protocol/prot.h"
+#include "protocol/sec-lsm-manager.h"
+#include "protocol/sec-lsm-manager-protocol.h"
+#include "protocol/socket.h"
 
 /* the format is STREAM [ FIELDS...] NULL until a NULL line */
 const char *data[] = {
@@ -294,6 +301,277 @@ static void test_write_read(int allow_empty, int urge) {
     prot_destroy(prot);
 }
 
+static void test_big_record(void) {
+
+    static char path1[1025], path2[1025];
+    const char *out[4] = { "plug", path1, "some-id", path2 };
+    const char **fields;
+    int n, sts, fds[2];
+    prot_t *prot = NULL;
+
+    // create the prot object
+    prot_create(&prot);
+    ck_assert_ptr_ne(NULL, prot);
+
+    // the record is bigger than the initial buffers
+    memset(path1, 'a', sizeof path1 - 1);
+    memset(path2, 'b', sizeof path2 - 1);
+    path1[10] = ' ';
+    path2[20] = '\\';
+
+    // the buffers don't grow above the maximum
+    prot_set_max_buffer_length(prot, 2048);
+    sts = prot_put(prot, 4, out);
+    ck_assert_int_eq(-ECANCELED, sts);
+    ck_assert_int_eq(0, prot_should_write(prot));
+    prot_set_max_buffer_length(prot, 65536);
+
+    // creates the pipe
+    sts = pipe(fds);
+    ck_assert_int_eq(0, sts);
+
+    // send it
+    sts = prot_put(prot, 4, out);
+    ck_assert_int_eq(0, sts);
+    while (prot_should_write(prot)) {
+        sts = prot_write(prot, fds[1]);
+        ck_assert_int_lt(0, sts);
+    }
+
+    // receive it
+    while ((n = prot_get(prot, &fields)) == -EAGAIN) {
+        sts = prot_read(prot, fds[0]);
+        ck_assert_int_lt(0, sts);
+    }
+    ck_assert_int_eq(4, n);
+    for (n = 0 ; n < 4 ; n++)
+        ck_assert_str_eq(out[n], fields[n]);
+    prot_next(prot);
+
+    // cleaning
+    close(fds[0]);
+    close(fds[1]);
+    prot_destroy(prot);
+}
+
+
+static void test_binary(int allow_empty) {
+
+    const char **fields;
+    int i, j, n, sts, fds[2];
+    prot_t *prot = NULL;
+
+    // create the prot object
+    prot_create(&prot);
+    ck_assert_ptr_ne(NULL, prot);
+    prot_set_allow_empty(prot, allow_empty);
+
+    // set and check binary
+    ck_assert_int_eq(0, prot_is_binary(prot));
+    prot_set_binary(prot, 1);
+    ck_assert_int_eq(1, prot_is_binary(prot));
+
+    // creates the pipe
+    sts = pipe(fds);
+    ck_assert_int_eq(0, sts);
+
+    // send all
+    for (i = 0; data[i] != NULL ; i = i + n + 2) {
+        for (n = 0 ; data[i + n + 1] != NULL ; n++);
+        sts = prot_put(prot, (unsigned)n, &data[i + 1]);
+        ck_assert_int_eq(0, sts);
+    }
+    while (prot_should_write(prot)) {
+        sts = prot_write(prot, fds[1]);
+        ck_assert_int_lt(0, sts);
+    }
+
+    // receive all
+    for (i = 0; data[i] != NULL ; i = i + n + 2) {
+
+        // skip empty line if not received nor transmitted
+        if (data[i + 1] == NULL && !allow_empty) {
+            n = 0;
+            continue;
+        }
+
+        // read the record
+        while ((n = prot_get(prot, &fields)) == -EAGAIN) {
+            sts = prot_read(prot, fds[0]);
+            ck_assert_int_lt(0, sts);
+        }
+        ck_assert_int_ge(n, 0);
+
+        // check each field
+        for (j = 0 ; j < n ; j++)
+            ck_assert_str_eq(data[i + j + 1], fields[j]);
+        ck_assert_ptr_eq(NULL, data[i + n + 1]);
+        prot_next(prot);
+    }
+
+    // malformed record: field longer than the record
+    sts = (int)write(fds[1], "\0\0\0\5\0\7abc", 9);
+    ck_assert_int_eq(9, sts);
+    sts = prot_read(prot, fds[0]);
+    ck_assert_int_eq(9, sts);
+    ck_assert_int_eq(-EBADMSG, prot_get(prot, NULL));
+
+    // cleaning
+    close(fds[0]);
+    close(fds[1]);
+    prot_destroy(prot);
+}
+
+static void test_escape_runs(void) {
+
+    static const char specials[] = { ' ', '\n', '\\', 'x' };
+    char field[100], line[300];
+    const char *fields[2] = { field, "end" };
+    const char **got;
+    int len, at, sp, sts, fds[2];
+    prot_t *prot = NULL;
+
+    // create the prot object
+    prot_create(&prot);
+    ck_assert_ptr_ne(NULL, prot);
+
+    // creates the pipe
+    sts = pipe(fds);
+    ck_assert_int_eq(0, sts);
+
+    // specials at any position of runs of any length
+    for (len = 1 ; len < (int)sizeof field ; len++) {
+        for (at = 0 ; at < len ; at += 7) {
+            for (sp = 0 ; sp < (int)sizeof specials ; sp++) {
+                memset(field, 'a' + len % 26, (size_t)len);
+                field[at] = specials[sp];
+                field[len] = 0;
+
+                // encode
+                sts = prot_put(prot, 2, fields);
+                ck_assert_int_eq(0, sts);
+                sts = prot_write(prot, fds[1]);
+                ck_assert_int_lt(0, sts);
+                ck_assert_int_gt((int)sizeof line, sts);
+
+                // check the encoding
+                sts = (int)read(fds[0], line, (size_t)sts);
+                ck_assert_int_eq(len + 5 + (sp < 2 || (sp == 2 && at + 1 == len)), sts);
+                ck_assert_int_eq('\n', line[sts - 1]);
+
+                // decode
+                sts = (int)write(fds[1], line, (size_t)sts);
+                ck_assert_int_lt(0, sts);
+                sts = prot_read(prot, fds[0]);
+                ck_assert_int_lt(0, sts);
+                sts = prot_get(prot, &got);
+                ck_assert_int_eq(2, sts);
+                ck_assert_str_eq(field, got[0]);
+                ck_assert_str_eq("end", got[1]);
+                prot_next(prot);
+            }
+        }
+    }
+
+    // cleaning
+    close(fds[0]);
+    close(fds[1]);
+    prot_destroy(prot);
+}
+
+static void test_pass_fd(void) {
+
+    const char **fields;
+    int sts, fds[2], pfds[2], fd;
+    struct stat st1, st2;
+    prot_t *prot1 = NULL, *prot2 = NULL;
+
+    // create the prot objects
+    prot_create(&prot1);
+    ck_assert_ptr_ne(NULL, prot1);
+    prot_create(&prot2);
+    ck_assert_ptr_ne(NULL, prot2);
+
+    // creates the socket pair and the pipe to pass
+    sts = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    ck_assert_int_eq(0, sts);
+    sts = pipe(pfds);
+    ck_assert_int_eq(0, sts);
+
+    // nothing received
+    ck_assert_int_eq(-ENOENT, prot_get_fd(prot2));
+
+    // pass the file with a record
+    sts = prot_put_fd(prot1, pfds[0]);
+    ck_assert_int_eq(0, sts);
+    sts = prot_putx(prot1, "manifest", NULL);
+    ck_assert_int_eq(0, sts);
+    sts = prot_write(prot1, fds[1]);
+    ck_assert_int_eq(9, sts);
+
+    // receive the record and the file
+    sts = prot_read(prot2, fds[0]);
+    ck_assert_int_eq(9, sts);
+    sts = prot_get(prot2, &fields);
+    ck_assert_int_eq(1, sts);
+    ck_assert_str_eq("manifest", fields[0]);
+    fd = prot_get_fd(prot2);
+    ck_assert_int_le(0, fd);
+    ck_assert_int_eq(-ENOENT, prot_get_fd(prot2));
+    ck_assert_int_eq(0, fstat(fd, &st1));
+    ck_assert_int_eq(0, fstat(pfds[0], &st2));
+    ck_assert_int_eq((int)st1.st_ino, (int)st2.st_ino);
+    close(fd);
+    prot_next(prot2);
+
+    // a file passed with another record is not given to the next one
+    sts = prot_put_fd(prot1, pfds[0]);
+    ck_assert_int_eq(0, sts);
+    sts = prot_putx(prot1, "id", "x", NULL);
+    ck_assert_int_eq(0, sts);
+    sts = prot_write(prot1, fds[1]);
+    ck_assert_int_eq(5, sts);
+    sts = prot_putx(prot1, "manifest", NULL);
+    ck_assert_int_eq(0, sts);
+    sts = prot_write(prot1, fds[1]);
+    ck_assert_int_eq(9, sts);
+    sts = prot_read(prot2, fds[0]);
+    ck_assert_int_le(5, sts);
+    ck_assert_int_eq(-ENOENT, prot_get_fd(prot2));
+    sts = prot_get(prot2, &fields);
+    ck_assert_int_eq(2, sts);
+    ck_assert_str_eq("id", fields[0]);
+    prot_next(prot2);
+    if (prot_get(prot2, &fields) == -EAGAIN) {
+        sts = prot_read(prot2, fds[0]);
+        ck_assert_int_eq(9, sts);
+    }
+    sts = prot_get(prot2, &fields);
+    ck_assert_int_eq(1, sts);
+    ck_assert_str_eq("manifest", fields[0]);
+    ck_assert_int_eq(-ENOENT, prot_get_fd(prot2));
+    prot_next(prot2);
+
+    // pending files are dropped by reset
+    sts = prot_put_fd(prot1, pfds[0]);
+    ck_assert_int_eq(0, sts);
+    prot_reset(prot1);
+    sts = prot_putx(prot1, "x", NULL);
+    ck_assert_int_eq(0, sts);
+    sts = prot_write(prot1, fds[1]);
+    ck_assert_int_eq(2, sts);
+    sts = prot_read(prot2, fds[0]);
+    ck_assert_int_eq(2, sts);
+    ck_assert_int_eq(-ENOENT, prot_get_fd(prot2));
+
+    // cleaning
+    close(pfds[0]);
+    close(pfds[1]);
+    close(fds[0]);
+    close(fds[1]);
+    prot_destroy(prot1);
+    prot_destroy(prot2);
+}
 
 START_TEST(test_prot_create) {
     prot_t *prot = NULL;
@@ -336,6 +614,127 @@ START_TEST(test_prot_write_read) {
 }
 END_TEST
 
+START_TEST(test_prot_binary) {
+    test_binary(0);
+    test_binary(1);
+}
+END_TEST
+
+START_TEST(test_prot_escape_runs) {
+    test_escape_runs();
+}
+END_TEST
+
+START_TEST(test_prot_big_record) {
+    test_big_record();
+}
+END_TEST
+
+START_TEST(test_prot_pass_fd) {
+    test_pass_fd();
+}
+END_TEST
+
+/**
+ * state of the server of test_batch_v2
+ */
+typedef struct {
+    int fd;
+    int requests;
+    int names;
+} batch_server_t;
+
+/* accepts version 2 and replies done to opcodes, error to names */
+static void *batch_server(void *arg) {
+    batch_server_t *server = arg;
+    const char **fields;
+    prot_t *prot;
+    int fd, rc;
+    bool ok;
+
+    fd = accept(server->fd, NULL, NULL);
+    ck_assert_int_le(0, fd);
+    ck_assert_int_eq(0, prot_create(&prot));
+    for (;;) {
+        rc = prot_get(prot, &fields);
+        if (rc == -EAGAIN) {
+            if (prot_read(prot, fd) <= 0)
+                break;
+            continue;
+        }
+        ck_assert_int_lt(0, rc);
+        if (!prot_is_binary(prot)) {
+            // hand-shake
+            ck_assert_str_eq(fields[0], _sec_lsm_manager_);
+            ck_assert_int_eq(0, prot_putx(prot, _done_, "2", NULL));
+            ck_assert_int_lt(0, prot_write(prot, fd));
+            prot_set_binary(prot, 1);
+        }
+        else {
+            server->requests++;
+            ok = sec_lsm_manager_opcode_of_code(fields[0]) != opcode_none;
+            if (!ok)
+                server->names++;
+            ck_assert_int_eq(0, prot_putx(prot, sec_lsm_manager_opcode_code(ok ? opcode_done : opcode_error),
+                                          ok ? NULL : "protocol", NULL));
+            ck_assert_int_lt(0, prot_write(prot, fd));
+        }
+        prot_next(prot);
+    }
+    prot_destroy(prot);
+    close(fd);
+    return NULL;
+}
+
+START_TEST(test_batch_v2) {
+    char spec[64];
+    batch_server_t server = { .fd = -1, .requests = 0, .names = 0 };
+    sec_lsm_manager_t *client;
+    pthread_t thread;
+
+    snprintf(spec, sizeof spec, "unix:@test-batch-v2-%d", (int)getpid());
+    server.fd = socket_open(spec, 1);
+    ck_assert_int_le(0, server.fd);
+    ck_assert_int_eq(0, pthread_create(&thread, NULL, batch_server, &server));
+
+    // in version 2, the requests of batches are sent with their opcode
+    ck_assert_int_eq(0, sec_lsm_manager_create(&client, spec));
+    ck_assert_int_eq(0, sec_lsm_manager_batch_begin(client, NULL, NULL));
+    ck_assert_int_eq(0, sec_lsm_manager_set_id(client, "app"));
+    ck_assert_int_eq(0, sec_lsm_manager_add_permission(client, "perm"));
+    ck_assert_int_eq(0, sec_lsm_manager_clear(client));
+    ck_assert_int_eq(0, sec_lsm_manager_batch_commit(client));
+    sec_lsm_manager_destroy(client);
+
+    pthread_join(thread, NULL);
+    close(server.fd);
+    ck_assert_int_eq(server.requests, 3);
+    ck_assert_int_eq(server.names, 0);
+}
+END_TEST
+
+START_TEST(test_manifest_lock) {
+    char spec[64];
+    sec_lsm_manager_t *client;
+
+    // no server, the client connects lazily
+    snprintf(spec, sizeof spec, "unix:@test-manifest-lock-%d", (int)getpid());
+    ck_assert_int_eq(0, sec_lsm_manager_create(&client, spec));
+
+    // requests other than the ones of the manifest are locked until commit
+    ck_assert_int_eq(0, sec_lsm_manager_manifest_begin(client));
+    ck_assert_int_eq(-EBUSY, sec_lsm_manager_manifest_begin(client));
+    ck_assert_int_eq(-EBUSY, sec_lsm_manager_batch_begin(client, NULL, NULL));
+    ck_assert_int_eq(-EBUSY, sec_lsm_manager_log(client, 0, 0));
+    ck_assert_int_eq(0, sec_lsm_manager_set_id(client, "app"));
+    ck_assert_int_gt(0, sec_lsm_manager_manifest_commit(client));
+
+    // the failed commit released the lock
+    ck_assert_int_ne(-EBUSY, sec_lsm_manager_log(client, 0, 0));
+    sec_lsm_manager_destroy(client);
+}
+END_TEST
+
 void test_prot(void) {
     addtest(test_prot_create);
     addtest(test_prot_put_field_by_field);
@@ -343,6 +742,12 @@ void test_prot(void) {
     addtest(test_prot_put_all);
     addtest(test_prot_read);
     addtest(test_prot_write_read);
+    addtest(test_prot_big_record);
+    addtest(test_prot_escape_runs);
+    addtest(test_prot_binary);
+    addtest(test_prot_pass_fd);
+    addtest(test_batch_v2);
+    addtest(test_manifest_lock);
 }
 
 
@@ -18,6 +18,7 @@
 #include "setup-tests.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <errno.h>
@@ -26,6 +27,11 @@
 #include "file-utils.h"
 #include "lsm-smack/smack.h"
 #include "lsm-smack/smack-template.h"
+#include "lsm-smack/smack-rules.h"
+#include "lsm-smack/xattr-smack.h"
+#if SIMULATE_SMACK
+#include "simulation/smack/smack.h"
+#endif
 
 // START_TEST(test_label_file) {
 //     char label[SEC_LSM_MANAGER_MAX_SIZE_LABEL] = {'\0'};
@@ -112,6 +118,22 @@ START_TEST(test_smack_install) {
     char public_dir[SEC_LSM_MANAGER_MAX_SIZE_DIR+20];
     char public_file[SEC_LSM_MANAGER_MAX_SIZE_PATH+20];
     char rule_path[SEC_LSM_MANAGER_MAX_SIZE_PATH + 1];
+    char template_file[SEC_LSM_MANAGER_MAX_SIZE_PATH+20];
+    FILE *file;
+#if SIMULATE_SMACK
+    char *applied;
+#endif
+
+    // template giving rules to the permissions
+    snprintf(template_file, sizeof template_file, "%s/template.smack", tmp_dir);
+    file = fopen(template_file, "w");
+    ck_assert_ptr_ne(file, NULL);
+    fputs("System App:{{id}} rwxa\n"
+          "{{#p=perm1}}App:{{id}} Perm:One rx\n{{/p=perm1}}"
+          "{{#p=perm2}}App:{{id}} Perm:Two rx\n{{/p=perm2}}"
+          "{{#p=perm3}}App:{{id}} Perm:Three rx\n{{/p=perm3}}", file);
+    fclose(file);
+    ck_assert_int_eq(setenv("SMACK_TEMPLATE_FILE", template_file, 1), 0);
 
     snprintf(data_dir, sizeof data_dir, "%s/data/", tmp_dir);
     snprintf(data_file, sizeof data_file, "%s/data/data_file", tmp_dir);
@@ -168,8 +190,40 @@ START_TEST(test_smack_install) {
     ck_assert_int_eq(compare_xattr(public_dir, XATTR_NAME_SMACK, "System:Shared"), true);
     ck_assert_int_eq(compare_xattr(public_dir, XATTR_NAME_SMACKTRANSMUTE, "TRUE"), true);
     ck_assert_int_eq(compare_xattr(public_file, XATTR_NAME_SMACK, "System:Shared"), true);
+#if SIMULATE_SMACK
+    applied = smack_simulation_applied();
+    ck_assert_str_eq(applied, "System App:testid rwxa\n"
+                              "App:testid Perm:One rx\n"
+                              "App:testid Perm:Two rx\n");
+    free(applied);
+#endif
+
+    // reinstall over the previous rules: only the new rules are applied
+    ck_assert_int_eq(context_add_permission(context, "perm3"), 0);
+    ck_assert_int_eq(smack_install(context), 0);
+    get_file_informations(rule_path, true, &exists, NULL, NULL);
+    ck_assert_int_eq(exists, true);
+#if SIMULATE_SMACK
+    applied = smack_simulation_applied();
+    ck_assert_str_eq(applied, "App:testid Perm:Three rx\n");
+    free(applied);
+#endif
+
+    // the rules of a removed permission get the access "-"
+    context_clear(context);
+    ck_assert_int_eq(context_set_id(context, "testid"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm2"), 0);
+    ck_assert_int_eq(context_add_permission(context, "perm3"), 0);
+    ck_assert_int_eq(smack_install(context), 0);
+#if SIMULATE_SMACK
+    applied = smack_simulation_applied();
+    ck_assert_str_eq(applied, "App:testid Perm:One -\n");
+    free(applied);
+#endif
 
     ck_assert_int_eq(smack_uninstall(context), 0);
+    ck_assert_int_eq(unsetenv("SMACK_TEMPLATE_FILE"), 0);
+    remove(template_file);
 
     context_destroy(context);
     remove(data_file);
@@ -217,8 +271,65 @@ START_TEST(test_smack_uninstall) {
 }
 END_TEST
 
+static void check_rule(const smack_rule_t *rule, const char *subject, const char *object,
+                       const char *access, const char *deny)
+{
+    ck_assert_str_eq(rule->subject, subject);
+    ck_assert_str_eq(rule->object, object);
+    ck_assert_str_eq(rule->access, access);
+    if (deny == NULL)
+        ck_assert_ptr_eq(rule->deny, NULL);
+    else
+        ck_assert_str_eq(rule->deny, deny);
+}
+
+START_TEST(test_smack_rules_delta) {
+    char previous_text[] = "A B rwx\nA C r\nA D rw\nA E r -\n\nX Y rx\n";
+    char text[] = "X Y rx\nA B\trwx\nZ Y t\nA E r w\nA C rw";
+    char invalid[] = "A B rwx\nA B\n";
+    char empty[] = "";
+    smack_rule_t *previous, *rules, *delta;
+    size_t nprevious, count, ndelta;
+
+    ck_assert_int_eq(smack_rules_parse(previous_text, &previous, &nprevious), 0);
+    ck_assert_int_eq((int)nprevious, 5);
+    check_rule(&previous[3], "A", "E", "r", "-");
+    ck_assert_int_eq(smack_rules_parse(text, &rules, &count), 0);
+    ck_assert_int_eq((int)count, 5);
+    check_rule(&rules[1], "A", "B", "rwx", NULL);
+    ck_assert_int_eq(smack_rules_parse(invalid, &delta, &ndelta), -EINVAL);
+
+    // unchanged pairs are skipped
+    ck_assert_int_eq(smack_rules_delta(previous, nprevious, rules, count, &delta, &ndelta), 0);
+    ck_assert_int_eq((int)ndelta, 5);
+    check_rule(&delta[0], "A", "C", "rw", NULL);
+    check_rule(&delta[1], "A", "D", "-", NULL);
+    check_rule(&delta[2], "A", "E", "-", NULL);
+    check_rule(&delta[3], "A", "E", "r", "w");
+    check_rule(&delta[4], "Z", "Y", "t", NULL);
+    free(delta);
+
+    ck_assert_int_eq(smack_rules_delta(rules, count, rules, count, &delta, &ndelta), 0);
+    ck_assert_int_eq((int)ndelta, 0);
+    free(delta);
+
+    // all removed
+    free(rules);
+    ck_assert_int_eq(smack_rules_parse(empty, &rules, &count), 0);
+    ck_assert_int_eq((int)count, 0);
+    ck_assert_int_eq(smack_rules_delta(previous, nprevious, rules, count, &delta, &ndelta), 0);
+    ck_assert_int_eq((int)ndelta, 5);
+    check_rule(&delta[4], "X", "Y", "-", NULL);
+    free(delta);
+
+    free(rules);
+    free(previous);
+}
+END_TEST
+
 void test_smack() {
     addtest(test_label_path);
     addtest(test_smack_install);
     addtest(test_smack_uninstall);
+    addtest(test_smack_rules_delta);
 }
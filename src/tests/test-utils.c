@@ -21,8 +21,11 @@
  * $RP_END_LICENSE$
  */
 
+#include <dirent.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -31,6 +34,7 @@
 #include "file-utils.h"
 #include "path-utils.h"
 #include "sizes.h"
+#include "utf8-utils.h"
 
 START_TEST(test_check_file_exists) {
     bool exists;
@@ -92,6 +96,49 @@ START_TEST(test_remove_file) {
 }
 END_TEST
 
+START_TEST(test_write_file) {
+    char tmp_dir[SEC_LSM_MANAGER_MAX_SIZE_DIR] = {'\0'};
+    char path[SEC_LSM_MANAGER_MAX_SIZE_PATH];
+    struct stat s;
+    struct dirent *ent;
+    DIR *dir;
+    char *content;
+    int count = 0;
+
+    create_tmp_dir(tmp_dir);
+    snprintf(path, sizeof path, "%s/rules", tmp_dir);
+
+    ck_assert_int_eq(write_file(path, "first", 5), 0);
+    content = read_file(path);
+    ck_assert_str_eq(content, "first");
+    free(content);
+    ck_assert_int_eq(stat(path, &s), 0);
+    ck_assert_int_eq((int)(s.st_mode & 07777), 0644);
+
+    /* the mode of the replaced file is kept */
+    chmod(path, 0600);
+    ck_assert_int_eq(write_file(path, "second", 6), 0);
+    content = read_file(path);
+    ck_assert_str_eq(content, "second");
+    free(content);
+    ck_assert_int_eq(stat(path, &s), 0);
+    ck_assert_int_eq((int)(s.st_mode & 07777), 0600);
+
+    /* no temporary file is left */
+    dir = opendir(tmp_dir);
+    ck_assert_ptr_nonnull(dir);
+    while ((ent = readdir(dir)) != NULL)
+        count += ent->d_name[0] != '.';
+    closedir(dir);
+    ck_assert_int_eq(count, 1);
+
+    remove(path);
+    snprintf(path, sizeof path, "%s/none/rules", tmp_dir);
+    ck_assert_int_eq(write_file(path, "third", 5), -ENOENT);
+    rmdir(tmp_dir);
+}
+END_TEST
+
 // IREV2: test suite for src/path-utils.c#path_std()
 START_TEST(test_path_std) {
     const char* data[][2] = {
@@ -118,10 +165,90 @@ START_TEST(test_path_std) {
 }
 END_TEST
 
+/* byte by byte implementation of is_utf8 used as reference */
+static bool reference_is_utf8(const char *text)
+{
+    unsigned len;
+    const unsigned char *iter = (const unsigned char *)text;
+    while (*iter) {
+        if (*iter <= 0x7f)
+            len = 0;
+        else if (*iter <= 0xbf)
+            return false;
+        else if (*iter <= 0xdf)
+            len = 1;
+        else if (*iter <= 0xef)
+            len = 2;
+        else if (*iter <= 0xf7)
+            len = 3;
+        else
+            return false;
+        for (iter++; len ; len--, iter++)
+            if (*iter < 0x80 || *iter > 0xbf)
+                return false;
+    }
+    return true;
+}
+
+static void check_is_utf8(const char *text)
+{
+    ck_assert_msg(is_utf8(text) == reference_is_utf8(text), "is_utf8 differs for \"%s\"", text);
+}
+
+START_TEST(test_is_utf8) {
+    static const unsigned char bytes[] = {
+        0x01, 'a', 0x7f, 0x80, 0xbf, 0xc0, 0xdf, 0xe0, 0xef, 0xf0, 0xf7, 0xf8, 0xff
+    };
+    const unsigned nbytes = (unsigned)sizeof bytes;
+    static const char *fills[] = { "a", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80" };
+    char text[128];
+    unsigned code, count, val, len, ifill, pre, idx, pos, round;
+
+    ck_assert(is_utf8(""));
+    ck_assert(is_utf8("/süß/€/😀"));
+    ck_assert(!is_utf8("\xc3"));
+    ck_assert(!is_utf8("aaaaaaaaaaaaaaa\xe2\x82"));
+
+    /* all sequences of 1 to 4 interesting bytes, at many positions of a block */
+    for (ifill = 0 ; ifill < sizeof fills / sizeof *fills ; ifill++)
+        for (pre = 0 ; pre <= 34 ; pre = pre < 3 || pre >= 26 ? pre + 1 : pre + 8)
+            for (len = 1, count = nbytes ; len <= 4 ; len++, count *= nbytes)
+                for (code = 0 ; code < count ; code++) {
+                    for (pos = 0 ; pos < pre ; pos += (unsigned)strlen(fills[ifill]))
+                        strcpy(&text[pos], fills[ifill]);
+                    for (idx = 0, val = code ; idx < len ; idx++, val /= nbytes)
+                        text[pos + idx] = (char)bytes[val % nbytes];
+                    strcpy(&text[pos + len], "tail of the text, long enough");
+                    check_is_utf8(text);
+                    text[pos + len] = 0;
+                    check_is_utf8(text);
+                }
+
+    /* random texts made of interesting bytes and valid sequences */
+    srand(1234);
+    for (round = 0 ; round < 100000 ; round++) {
+        len = (unsigned)rand() % 100;
+        for (pos = 0 ; pos < len ; ) {
+            if (rand() % 4 == 0)
+                text[pos++] = (char)bytes[(unsigned)rand() % nbytes];
+            else {
+                ifill = (unsigned)rand() % (unsigned)(sizeof fills / sizeof *fills);
+                strcpy(&text[pos], fills[ifill]);
+                pos += (unsigned)strlen(fills[ifill]);
+            }
+        }
+        text[pos] = 0;
+        check_is_utf8(text);
+    }
+}
+END_TEST
+
 void test_utils(void) {
     addtest(test_check_file_exists);
     addtest(test_check_dir);
     addtest(test_check_executable);
     addtest(test_remove_file);
+    addtest(test_write_file);
     addtest(test_path_std);
+    addtest(test_is_utf8);
 }
@@ -24,28 +24,149 @@
 
 #include "utf8-utils.h"
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/*
+ * The accepted encoding is the permissive one historically checked byte
+ * after byte: a lead byte in C0..DF, E0..EF or F0..F7 is followed by exactly
+ * 1, 2 or 3 continuation bytes in 80..BF, bytes F8..FF are rejected and
+ * neither overlong forms nor surrogates are checked.
+ *
+ * Stated positionally, the text is valid when none of its bytes is in F8..FF
+ * and when each of its bytes is a continuation byte if and only if one of the
+ * 3 bytes before it is a lead byte whose sequence covers it, the terminating
+ * nul included. This local rule is what is checked here, many bytes at once.
+ */
+
+/**
+ * @brief Get the count of continuation bytes announced by a byte
+ *
+ * @param[in] c the byte
+ * @return 1, 2 or 3 for a lead byte, 0 otherwise
+ */
+static inline unsigned lead_length(unsigned char c)
+{
+    return c < 0xc0 ? 0 : c < 0xe0 ? 1 : c < 0xf0 ? 2 : c < 0xf8 ? 3 : 0;
+}
+
+/**
+ * @brief Check the positional rule for the bytes of text from begin to end,
+ * end being excluded
+ *
+ * @param[in] text the text
+ * @param[in] begin index of the first byte to check
+ * @param[in] end index after the last byte to check
+ * @return true when valid, false otherwise
+ */
+static bool check_bytes(const unsigned char *text, size_t begin, size_t end)
+{
+    size_t idx;
+    bool cont;
+
+    for (idx = begin ; idx < end ; idx++) {
+        if (text[idx] >= 0xf8)
+            return false;
+        cont = (idx >= 1 && lead_length(text[idx - 1]) >= 1)
+            || (idx >= 2 && lead_length(text[idx - 2]) >= 2)
+            || (idx >= 3 && lead_length(text[idx - 3]) >= 3);
+        if (cont != (text[idx] >= 0x80 && text[idx] <= 0xbf))
+            return false;
+    }
+    return true;
+}
+
 /* see utf8-utils.h */
 bool is_utf8(const char *text)
 {
-    unsigned len;
-    const unsigned char *iter = (const unsigned char *)text;
-    while (*iter) {
-        if (*iter <= 0x7f)
-            len = 0;
-        else if (*iter <= 0xbf)
+    const unsigned char *str = (const unsigned char *)text;
+    size_t length = strlen(text);
+    size_t idx = 0;
+#if defined(__SSE2__)
+    /* bytes are compared signed: 80..BF is -128..-65, C0..F7 is -64..-9 */
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bf = _mm_set1_epi8((char)0xbf);
+    const __m128i df = _mm_set1_epi8((char)0xdf);
+    const __m128i ef = _mm_set1_epi8((char)0xef);
+    const __m128i f8 = _mm_set1_epi8((char)0xf8);
+    const __m128i f7 = _mm_set1_epi8((char)0xf7);
+    __m128i cur, lead1, lead2, lead3, cont, err, pend = zero;
+
+    for ( ; idx + 16 <= length ; idx += 16) {
+        cur = _mm_loadu_si128((const __m128i*)&str[idx]);
+        if (!_mm_movemask_epi8(cur)) {
+            /* only ASCII, valid unless a sequence is pending */
+            if (_mm_movemask_epi8(pend))
+                return false;
+            continue;
+        }
+        lead1 = _mm_and_si128(_mm_cmpgt_epi8(cur, bf), _mm_cmplt_epi8(cur, f8));
+        lead2 = _mm_and_si128(_mm_cmpgt_epi8(cur, df), lead1);
+        lead3 = _mm_and_si128(_mm_cmpgt_epi8(cur, ef), lead1);
+        cont = _mm_or_si128(pend,
+                _mm_or_si128(_mm_slli_si128(lead1, 1),
+                    _mm_or_si128(_mm_slli_si128(lead2, 2), _mm_slli_si128(lead3, 3))));
+        err = _mm_xor_si128(cont, _mm_cmplt_epi8(cur, _mm_set1_epi8((char)0xc0)));
+        err = _mm_or_si128(err, _mm_and_si128(_mm_cmpgt_epi8(cur, f7), _mm_cmplt_epi8(cur, zero)));
+        if (_mm_movemask_epi8(err))
             return false;
-        else if (*iter <= 0xdf)
-            len = 1;
-        else if (*iter <= 0xef)
-            len = 2;
-        else if (*iter <= 0xf7)
-            len = 3;
-        else
+        pend = _mm_or_si128(_mm_srli_si128(lead1, 15),
+                _mm_or_si128(_mm_srli_si128(lead2, 14), _mm_srli_si128(lead3, 13)));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t zero = vdupq_n_u8(0);
+    uint8x16_t cur, lead1, lead2, lead3, cont, err;
+    uint8x16_t prev1 = zero, prev2 = zero, prev3 = zero;
+
+    for ( ; idx + 16 <= length ; idx += 16) {
+        cur = vld1q_u8(&str[idx]);
+        if (vmaxvq_u8(cur) < 0x80) {
+            /* only ASCII, valid unless a sequence is pending */
+            if (vmaxvq_u8(vorrq_u8(vextq_u8(prev1, zero, 15),
+                    vorrq_u8(vextq_u8(prev2, zero, 14), vextq_u8(prev3, zero, 13)))))
+                return false;
+            prev1 = prev2 = prev3 = zero;
+            continue;
+        }
+        lead1 = vandq_u8(vcgeq_u8(cur, vdupq_n_u8(0xc0)), vcltq_u8(cur, vdupq_n_u8(0xf8)));
+        lead2 = vandq_u8(vcgeq_u8(cur, vdupq_n_u8(0xe0)), lead1);
+        lead3 = vandq_u8(vcgeq_u8(cur, vdupq_n_u8(0xf0)), lead1);
+        cont = vorrq_u8(vextq_u8(prev1, lead1, 15),
+                vorrq_u8(vextq_u8(prev2, lead2, 14), vextq_u8(prev3, lead3, 13)));
+        err = veorq_u8(cont, vandq_u8(vcgeq_u8(cur, vdupq_n_u8(0x80)), vcltq_u8(cur, vdupq_n_u8(0xc0))));
+        err = vorrq_u8(err, vcgeq_u8(cur, vdupq_n_u8(0xf8)));
+        if (vmaxvq_u8(err))
             return false;
-        for (iter++; len ; len--, iter++)
-            if (*iter < 0x80 || *iter > 0xbf)
+        prev1 = lead1;
+        prev2 = lead2;
+        prev3 = lead3;
+    }
+#else
+    uint64_t word;
+    bool ascii = true;
+
+    for ( ; idx + sizeof word <= length ; idx += sizeof word) {
+        memcpy(&word, &str[idx], sizeof word);
+        if (word & UINT64_C(0x8080808080808080)) {
+            ascii = false;
+            if (!check_bytes(str, idx, idx + sizeof word))
                 return false;
+        }
+        else if (!ascii) {
+            /* only ASCII, a pending sequence would cover its first byte */
+            ascii = true;
+            if (!check_bytes(str, idx, idx + 1))
+                return false;
+        }
     }
-    return true;
+#endif
+    /* check the remaining bytes and the terminating nul */
+    return check_bytes(str, idx, length + 1);
 }
-